@@ -8,9 +8,11 @@ Totally blocking.
  */
 
 
+#include <chrono>
 #include <cstdio>
 #include <cassert>
 #include <cstdlib>
+#include <cstring>
 #include "legion.h"
 using namespace Legion;
 
@@ -129,75 +131,94 @@ double HEvaluator(const Task *task,
 }
 
 
+// the value following flag on the command line, or def
+static const char* InputArg(const char* flag, const char* def)
+{
+  const InputArgs& args = Runtime::get_input_args();
+  for (int i = 1; i < args.argc - 1; ++i)
+    if (!strcmp(args.argv[i], flag)) return args.argv[i+1];
+  return def;
+}
+
+
 void top_level_task(const Task *task,
 		  const std::vector<PhysicalRegion> &regions,
 		  Context ctx, Runtime *runtime)
 {
+  int nsteps = std::atoi(InputArg("-steps", "1"));
+
   // manually form the graph
   double a,b,c,d,e,f,g,h;
+  auto start = std::chrono::steady_clock::now();
   
-  // leaf level is primaries
-  {
-    std::cout << "(Launching B): ";
-    TaskLauncher B(BEvaluator_ID, TaskArgument());
-    auto b_future = runtime->execute_task(ctx, B);
-    b = b_future.get_result<double>();
-  }
-
-  {
-    std::cout << "(Launching G): ";
-    TaskLauncher G(GEvaluator_ID, TaskArgument());
-    auto g_future = runtime->execute_task(ctx, G);
-    g = g_future.get_result<double>();
-  }
-
-  // second tier
-  {
-    std::cout << "(Launching D): ";
-    TaskLauncher D(DEvaluator_ID, TaskArgument(&g, sizeof(g)));
-    auto d_future = runtime->execute_task(ctx, D);
-    d = d_future.get_result<double>();
+  for (int step = 0; step != nsteps; ++step) {
+    // leaf level is primaries
+    {
+      std::cout << "(Launching B): ";
+      TaskLauncher B(BEvaluator_ID, TaskArgument());
+      auto b_future = runtime->execute_task(ctx, B);
+      b = b_future.get_result<double>();
+    }
+
+    {
+      std::cout << "(Launching G): ";
+      TaskLauncher G(GEvaluator_ID, TaskArgument());
+      auto g_future = runtime->execute_task(ctx, G);
+      g = g_future.get_result<double>();
+    }
+
+    // second tier
+    {
+      std::cout << "(Launching D): ";
+      TaskLauncher D(DEvaluator_ID, TaskArgument(&g, sizeof(g)));
+      auto d_future = runtime->execute_task(ctx, D);
+      d = d_future.get_result<double>();
+    }
+
+    {
+      std::cout << "(Launching F): ";
+      TaskLauncher F(FEvaluator_ID, TaskArgument(&g, sizeof(g)));
+      auto f_future = runtime->execute_task(ctx, F);
+      f = f_future.get_result<double>();
+    }
+
+    // third tier
+    {
+      std::cout << "(Launching C): ";
+      auto argC = std::make_tuple(d,g);
+      TaskLauncher C(CEvaluator_ID, TaskArgument(&argC, sizeof(argC)));
+      auto c_future = runtime->execute_task(ctx, C);
+      c = c_future.get_result<double>();
+    }
+
+    {
+      std::cout << "(Launching E): ";
+      auto argE = std::make_tuple(d,f);
+      TaskLauncher E(EEvaluator_ID, TaskArgument(&argE, sizeof(argE)));
+      auto e_future = runtime->execute_task(ctx, E);
+      e = e_future.get_result<double>();
+    }
+
+    {
+      std::cout << "(Launching H): ";
+      TaskLauncher H(HEvaluator_ID, TaskArgument(&f, sizeof(double)));
+      auto h_future = runtime->execute_task(ctx, H);
+      h = h_future.get_result<double>();
+    }
+
+    // fourth tier
+    {
+      std::cout << "(Launching A): ";
+      auto argA = std::make_tuple(b,c,e,h);
+      TaskLauncher A(AEvaluator_ID, TaskArgument(&argA, sizeof(argA)));
+      auto a_future = runtime->execute_task(ctx, A);
+      a = a_future.get_result<double>();
+    }
   }
 
-  {
-    std::cout << "(Launching F): ";
-    TaskLauncher F(FEvaluator_ID, TaskArgument(&g, sizeof(g)));
-    auto f_future = runtime->execute_task(ctx, F);
-    f = f_future.get_result<double>();
-  }
-
-  // third tier
-  {
-    std::cout << "(Launching C): ";
-    auto argC = std::make_tuple(d,g);
-    TaskLauncher C(CEvaluator_ID, TaskArgument(&argC, sizeof(argC)));
-    auto c_future = runtime->execute_task(ctx, C);
-    c = c_future.get_result<double>();
-  }
-
-  {
-    std::cout << "(Launching E): ";
-    auto argE = std::make_tuple(d,f);
-    TaskLauncher E(EEvaluator_ID, TaskArgument(&argE, sizeof(argE)));
-    auto e_future = runtime->execute_task(ctx, E);
-    e = e_future.get_result<double>();
-  }
-
-  {
-    std::cout << "(Launching H): ";
-    TaskLauncher H(HEvaluator_ID, TaskArgument(&f, sizeof(double)));
-    auto h_future = runtime->execute_task(ctx, H);
-    h = h_future.get_result<double>();
-  }
-
-  // fourth tier
-  {
-    std::cout << "(Launching A): ";
-    auto argA = std::make_tuple(b,c,e,h);
-    TaskLauncher A(AEvaluator_ID, TaskArgument(&argA, sizeof(argA)));
-    auto a_future = runtime->execute_task(ctx, A);
-    a = a_future.get_result<double>();
-  }
+  // every task blocked, so the DAG is done
+  double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  printf("Timing: %d cells, %d colors, %d steps, %.6e s\n", 1, 1, nsteps, elapsed);
 }
 
 
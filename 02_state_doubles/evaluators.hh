@@ -91,6 +91,13 @@ public:
   // primary variables provide themselves only
   virtual bool ProvidesKey(const Key& key) const override;
 
+  // marks the primary as changed, e.g. at a new step, so that it is
+  // relaunched and everything depending upon it recomputed
+  void SetChanged() {
+    done_once_ = false;
+    requests_.clear();
+  }
+
 protected:
   void Update_(State& S);
   
@@ -1,8 +1,10 @@
 
+#include <chrono>
 #include <cmath>
 #include <cstdio>
 #include <cassert>
 #include <cstdlib>
+#include <cstring>
 #include "legion.h"
 using namespace Legion;
 
@@ -38,7 +40,32 @@ enum FieldIDs {
   FID_H
 };
 
-static const int g_ncells = 4;  // will need to figure this out sometime...
+// the number of cells in a task's (first) region
+static int NumCells(const Task *task, Context ctx, Runtime *runtime)
+{
+  return runtime->get_index_space_domain(ctx, task->regions[0].region.get_index_space()).get_volume();
+}
+
+// the value following flag on the command line, or def
+static const char* InputArg(const char* flag, const char* def)
+{
+  const InputArgs& args = Runtime::get_input_args();
+  for (int i = 1; i < args.argc - 1; ++i)
+    if (!strcmp(args.argv[i], flag)) return args.argv[i+1];
+  return def;
+}
+
+// whether -arcos:verbose was given, for a message per launch and task
+static bool Verbose()
+{
+  static const bool verbose = [] {
+    const InputArgs& args = Runtime::get_input_args();
+    for (int i = 1; i < args.argc; ++i)
+      if (!strcmp(args.argv[i], "-arcos:verbose")) return true;
+    return false;
+  }();
+  return verbose;
+}
 
 // Note, since all results are stored in regions, all tasks return an error
 // code.
@@ -55,11 +82,11 @@ void BEvaluator(const Task *task,
   // This is a field polymorphic function so figure out
   // which field we are responsible for initializing.
   FieldID fid = *(task->regions[0].privilege_fields.begin());
-  printf("Initializing B(field %d) = 2.0\n", fid);
+  if (Verbose()) printf("Initializing B(field %d) = 2.0\n", fid);
   assert(fid == FID_B);
 
   const FieldAccessor<WRITE_DISCARD,double,1> acc(regions[0], fid);
-  for (int i=0; i!=g_ncells; ++i) acc[i] = 2.;
+  for (int i=0, n=NumCells(task,ctx,runtime); i!=n; ++i) acc[i] = 2.;
 }
 
 
@@ -74,11 +101,11 @@ void GEvaluator(const Task *task,
   // This is a field polymorphic function so figure out
   // which field we are responsible for initializing.
   FieldID fid = *(task->regions[0].privilege_fields.begin());
-  printf("Initializing G (field %d) = 3.0\n", fid);
+  if (Verbose()) printf("Initializing G (field %d) = 3.0\n", fid);
   assert(fid == FID_G);
 
   const FieldAccessor<WRITE_DISCARD,double,1> acc(regions[0], fid);
-  for (int i=0; i!=g_ncells; ++i) acc[i] = 3.;
+  for (int i=0, n=NumCells(task,ctx,runtime); i!=n; ++i) acc[i] = 3.;
 }
 
 
@@ -101,8 +128,8 @@ void AEvaluator(const Task *task,
   // out
   const FieldAccessor<WRITE_DISCARD,double,1> fa(regions[0], FID_A);
 
-  for (int i=0; i!=g_ncells; ++i) fa[i] = 2*fb[i] + fc[i]*fe[i]*fh[i];
-  printf("Evaluating A = %g\n", (double) fa[0]);
+  for (int i=0, n=NumCells(task,ctx,runtime); i!=n; ++i) fa[i] = 2*fb[i] + fc[i]*fe[i]*fh[i];
+  if (Verbose()) printf("Evaluating A = %g\n", (double) fa[0]);
 }
 
 
@@ -122,8 +149,8 @@ void CEvaluator(const Task *task,
   // out
   const FieldAccessor<WRITE_DISCARD,double,1> fc(regions[0], FID_C);
 
-  for (int i=0; i!=g_ncells; ++i) fc[i] = 2 * fd[i] + fg[i];
-  printf("Evaluating C = %g\n", (double) fc[0]);
+  for (int i=0, n=NumCells(task,ctx,runtime); i!=n; ++i) fc[i] = 2 * fd[i] + fg[i];
+  if (Verbose()) printf("Evaluating C = %g\n", (double) fc[0]);
 }
 
 
@@ -142,8 +169,8 @@ void DEvaluator(const Task *task,
   // out
   const FieldAccessor<WRITE_DISCARD,double,1> fd(regions[0], FID_D);
 
-  for (int i=0; i!=g_ncells; ++i) fd[i] = 2 * fg[i];
-  printf("Evaluating D = %g\n", (double) fd[0]);
+  for (int i=0, n=NumCells(task,ctx,runtime); i!=n; ++i) fd[i] = 2 * fg[i];
+  if (Verbose()) printf("Evaluating D = %g\n", (double) fd[0]);
 }
 
 void EEvaluator(const Task *task,
@@ -162,8 +189,8 @@ void EEvaluator(const Task *task,
   // out
   const FieldAccessor<WRITE_DISCARD,double,1> fe(regions[0], FID_E);
 
-  for (int i=0; i!=g_ncells; ++i) fe[i] = fd[i] * ff[i];
-  printf("Evaluating E = %g\n", (double) fe[0]);
+  for (int i=0, n=NumCells(task,ctx,runtime); i!=n; ++i) fe[i] = fd[i] * ff[i];
+  if (Verbose()) printf("Evaluating E = %g\n", (double) fe[0]);
 }
 
 void FEvaluator(const Task *task,
@@ -181,8 +208,8 @@ void FEvaluator(const Task *task,
   // out
   const FieldAccessor<WRITE_DISCARD,double,1> ff(regions[0], FID_F);
 
-  for (int i=0; i!=g_ncells; ++i) ff[i] = 2 * fg[i];
-  printf("Evaluating F = %g\n", (double) ff[0]);
+  for (int i=0, n=NumCells(task,ctx,runtime); i!=n; ++i) ff[i] = 2 * fg[i];
+  if (Verbose()) printf("Evaluating F = %g\n", (double) ff[0]);
 }
 
 void HEvaluator(const Task *task,
@@ -200,8 +227,8 @@ void HEvaluator(const Task *task,
   // out
   const FieldAccessor<WRITE_DISCARD,double,1> fh(regions[0], FID_H);
 
-  for (int i=0; i!=g_ncells; ++i) fh[i] = 2 * ff[i];
-  printf("Evaluating H = %g\n", (double) fh[0]);
+  for (int i=0, n=NumCells(task,ctx,runtime); i!=n; ++i) fh[i] = 2 * ff[i];
+  if (Verbose()) printf("Evaluating H = %g\n", (double) fh[0]);
 }
 
 
@@ -216,7 +243,7 @@ void TestEvaluator(const Task *task,
   // in
   const FieldAccessor<READ_ONLY,double,1> fa(regions[0], FID_A);
 
-  for (int i=0; i!=g_ncells; ++i) {
+  for (int i=0, n=NumCells(task,ctx,runtime); i!=n; ++i) {
     assert(std::abs(fa[i] - 6484.0) < 1.e-10);
   }
   printf("Successful test!\n");
@@ -228,9 +255,11 @@ void top_level_task(const Task *task,
                     Context ctx, Runtime *runtime)
 {
   std::cout << "Top Level Task" << std::endl;
+  int ncells = std::atoi(InputArg("-cells", "4"));
+  int nsteps = std::atoi(InputArg("-steps", "1"));
 
-  // create a domain and index space of size g_ncells
-  const Domain domain(DomainPoint(0), DomainPoint(g_ncells-1));
+  // create a domain and index space of size ncells
+  const Domain domain(DomainPoint(0), DomainPoint(ncells-1));
   IndexSpace untyped_is = runtime->create_index_space(ctx, domain); 
   printf("Created untyped index space %x\n", untyped_is.get_id());
 
@@ -286,93 +315,100 @@ void top_level_task(const Task *task,
   r.wait_until_valid();
 
   // launch task for B IC
-  std::cout << "Launching B" << std::endl;
-  TaskLauncher Blauncher(TID_B, TaskArgument(NULL, 0));
-  Blauncher.add_region_requirement(
-      RegionRequirement(state_lr, WRITE_DISCARD, EXCLUSIVE, state_lr));
-  Blauncher.add_field(0,FID_B);
-  // Note that when we launch this task we don't record the future.
-  // This is because we're going to let Legion be responsible for 
-  // computing the data dependences between how different tasks access
-  // logical regions.
-  runtime->execute_task(ctx, Blauncher);
-
-  // launch task for G IC
-  std::cout << "Launching G" << std::endl;
-  TaskLauncher Glauncher(TID_G, TaskArgument(NULL, 0));
-  Glauncher.add_region_requirement(
-      RegionRequirement(state_lr, WRITE_DISCARD, EXCLUSIVE, state_lr));
-  Glauncher.add_field(0,FID_G);
-  runtime->execute_task(ctx, Glauncher);
-
-  // second level launches
-  std::cout << "Launching D" << std::endl;
-  TaskLauncher Dlauncher(TID_D, TaskArgument(NULL, 0));
-  Dlauncher.add_region_requirement(
-      RegionRequirement(state_lr, WRITE_DISCARD, EXCLUSIVE, state_lr));
-  Dlauncher.add_field(0, FID_D); // 0 refers to the 0th region requirement?
-  Dlauncher.add_region_requirement(
-      RegionRequirement(state_lr, READ_ONLY, EXCLUSIVE, state_lr));
-  Dlauncher.add_field(1, FID_G); // 0 refers to the 0th region requirement?
-  runtime->execute_task(ctx, Dlauncher);
-
-  std::cout << "Launching F" << std::endl;
-  TaskLauncher Flauncher(TID_F, TaskArgument(NULL, 0));
-  Flauncher.add_region_requirement(
-      RegionRequirement(state_lr, WRITE_DISCARD, EXCLUSIVE, state_lr));
-  Flauncher.add_field(0, FID_F); // 0 refers to the 0th region requirement?
-  Flauncher.add_region_requirement(
-      RegionRequirement(state_lr, READ_ONLY, EXCLUSIVE, state_lr));
-  Flauncher.add_field(1, FID_G); // 0 refers to the 0th region requirement?
-  runtime->execute_task(ctx, Flauncher);
-
-  // third level launches
-  std::cout << "Launching C" << std::endl;
-  TaskLauncher Clauncher(TID_C, TaskArgument(NULL, 0));
-  Clauncher.add_region_requirement(
-      RegionRequirement(state_lr, WRITE_DISCARD, EXCLUSIVE, state_lr));
-  Clauncher.add_field(0, FID_C); // 0 refers to the 0th region requirement?
-  Clauncher.add_region_requirement(
-      RegionRequirement(state_lr, READ_ONLY, EXCLUSIVE, state_lr));
-  Clauncher.add_field(1, FID_D); // 0 refers to the 0th region requirement?
-  Clauncher.add_field(1, FID_G); // 0 refers to the 0th region requirement?
-  runtime->execute_task(ctx, Clauncher);
+  auto start = std::chrono::steady_clock::now();
+  for (int step = 0; step != nsteps; ++step) {
+    if (Verbose()) std::cout << "Launching B" << std::endl;
+    TaskLauncher Blauncher(TID_B, TaskArgument(NULL, 0));
+    Blauncher.add_region_requirement(
+        RegionRequirement(state_lr, WRITE_DISCARD, EXCLUSIVE, state_lr));
+    Blauncher.add_field(0,FID_B);
+    // Note that when we launch this task we don't record the future.
+    // This is because we're going to let Legion be responsible for 
+    // computing the data dependences between how different tasks access
+    // logical regions.
+    runtime->execute_task(ctx, Blauncher);
+
+    // launch task for G IC
+    if (Verbose()) std::cout << "Launching G" << std::endl;
+    TaskLauncher Glauncher(TID_G, TaskArgument(NULL, 0));
+    Glauncher.add_region_requirement(
+        RegionRequirement(state_lr, WRITE_DISCARD, EXCLUSIVE, state_lr));
+    Glauncher.add_field(0,FID_G);
+    runtime->execute_task(ctx, Glauncher);
+
+    // second level launches
+    if (Verbose()) std::cout << "Launching D" << std::endl;
+    TaskLauncher Dlauncher(TID_D, TaskArgument(NULL, 0));
+    Dlauncher.add_region_requirement(
+        RegionRequirement(state_lr, WRITE_DISCARD, EXCLUSIVE, state_lr));
+    Dlauncher.add_field(0, FID_D); // 0 refers to the 0th region requirement?
+    Dlauncher.add_region_requirement(
+        RegionRequirement(state_lr, READ_ONLY, EXCLUSIVE, state_lr));
+    Dlauncher.add_field(1, FID_G); // 0 refers to the 0th region requirement?
+    runtime->execute_task(ctx, Dlauncher);
+
+    if (Verbose()) std::cout << "Launching F" << std::endl;
+    TaskLauncher Flauncher(TID_F, TaskArgument(NULL, 0));
+    Flauncher.add_region_requirement(
+        RegionRequirement(state_lr, WRITE_DISCARD, EXCLUSIVE, state_lr));
+    Flauncher.add_field(0, FID_F); // 0 refers to the 0th region requirement?
+    Flauncher.add_region_requirement(
+        RegionRequirement(state_lr, READ_ONLY, EXCLUSIVE, state_lr));
+    Flauncher.add_field(1, FID_G); // 0 refers to the 0th region requirement?
+    runtime->execute_task(ctx, Flauncher);
+
+    // third level launches
+    if (Verbose()) std::cout << "Launching C" << std::endl;
+    TaskLauncher Clauncher(TID_C, TaskArgument(NULL, 0));
+    Clauncher.add_region_requirement(
+        RegionRequirement(state_lr, WRITE_DISCARD, EXCLUSIVE, state_lr));
+    Clauncher.add_field(0, FID_C); // 0 refers to the 0th region requirement?
+    Clauncher.add_region_requirement(
+        RegionRequirement(state_lr, READ_ONLY, EXCLUSIVE, state_lr));
+    Clauncher.add_field(1, FID_D); // 0 refers to the 0th region requirement?
+    Clauncher.add_field(1, FID_G); // 0 refers to the 0th region requirement?
+    runtime->execute_task(ctx, Clauncher);
   
-  // third level launches
-  std::cout << "Launching E" << std::endl;
-  TaskLauncher Elauncher(TID_E, TaskArgument(NULL, 0));
-  Elauncher.add_region_requirement(
-      RegionRequirement(state_lr, WRITE_DISCARD, EXCLUSIVE, state_lr));
-  Elauncher.add_field(0, FID_E); // 0 refers to the 0th region requirement?
-  Elauncher.add_region_requirement(
-      RegionRequirement(state_lr, READ_ONLY, EXCLUSIVE, state_lr));
-  Elauncher.add_field(1, FID_D); // 0 refers to the 0th region requirement?
-  Elauncher.add_field(1, FID_F); // 0 refers to the 0th region requirement?
-  runtime->execute_task(ctx, Elauncher);
-
-  std::cout << "Launching H" << std::endl;
-  TaskLauncher Hlauncher(TID_H, TaskArgument(NULL, 0));
-  Hlauncher.add_region_requirement(
-      RegionRequirement(state_lr, WRITE_DISCARD, EXCLUSIVE, state_lr));
-  Hlauncher.add_field(0,FID_H);
-  Hlauncher.add_region_requirement(
-      RegionRequirement(state_lr, READ_ONLY, EXCLUSIVE, state_lr));
-  Hlauncher.add_field(1, FID_F); // 0 refers to the 0th region requirement?
-  runtime->execute_task(ctx, Hlauncher);
-
-  // fourth level launches
-  std::cout << "Launching A" << std::endl;
-  TaskLauncher Alauncher(TID_A, TaskArgument(NULL, 0));
-  Alauncher.add_region_requirement(
-      RegionRequirement(state_lr, WRITE_DISCARD, EXCLUSIVE, state_lr));
-  Alauncher.add_field(0,FID_A);
-  Alauncher.add_region_requirement(
-      RegionRequirement(state_lr, READ_ONLY, EXCLUSIVE, state_lr));
-  Alauncher.add_field(1, FID_B); // 0 refers to the 0th region requirement?
-  Alauncher.add_field(1, FID_C); // 0 refers to the 0th region requirement?
-  Alauncher.add_field(1, FID_E); // 0 refers to the 0th region requirement?
-  Alauncher.add_field(1, FID_H); // 0 refers to the 0th region requirement?
-  runtime->execute_task(ctx, Alauncher);
+    // third level launches
+    if (Verbose()) std::cout << "Launching E" << std::endl;
+    TaskLauncher Elauncher(TID_E, TaskArgument(NULL, 0));
+    Elauncher.add_region_requirement(
+        RegionRequirement(state_lr, WRITE_DISCARD, EXCLUSIVE, state_lr));
+    Elauncher.add_field(0, FID_E); // 0 refers to the 0th region requirement?
+    Elauncher.add_region_requirement(
+        RegionRequirement(state_lr, READ_ONLY, EXCLUSIVE, state_lr));
+    Elauncher.add_field(1, FID_D); // 0 refers to the 0th region requirement?
+    Elauncher.add_field(1, FID_F); // 0 refers to the 0th region requirement?
+    runtime->execute_task(ctx, Elauncher);
+
+    if (Verbose()) std::cout << "Launching H" << std::endl;
+    TaskLauncher Hlauncher(TID_H, TaskArgument(NULL, 0));
+    Hlauncher.add_region_requirement(
+        RegionRequirement(state_lr, WRITE_DISCARD, EXCLUSIVE, state_lr));
+    Hlauncher.add_field(0,FID_H);
+    Hlauncher.add_region_requirement(
+        RegionRequirement(state_lr, READ_ONLY, EXCLUSIVE, state_lr));
+    Hlauncher.add_field(1, FID_F); // 0 refers to the 0th region requirement?
+    runtime->execute_task(ctx, Hlauncher);
+
+    // fourth level launches
+    if (Verbose()) std::cout << "Launching A" << std::endl;
+    TaskLauncher Alauncher(TID_A, TaskArgument(NULL, 0));
+    Alauncher.add_region_requirement(
+        RegionRequirement(state_lr, WRITE_DISCARD, EXCLUSIVE, state_lr));
+    Alauncher.add_field(0,FID_A);
+    Alauncher.add_region_requirement(
+        RegionRequirement(state_lr, READ_ONLY, EXCLUSIVE, state_lr));
+    Alauncher.add_field(1, FID_B); // 0 refers to the 0th region requirement?
+    Alauncher.add_field(1, FID_C); // 0 refers to the 0th region requirement?
+    Alauncher.add_field(1, FID_E); // 0 refers to the 0th region requirement?
+    Alauncher.add_field(1, FID_H); // 0 refers to the 0th region requirement?
+    runtime->execute_task(ctx, Alauncher);
+  }
+
+  runtime->issue_execution_fence(ctx).get_void_result();
+  double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  printf("Timing: %d cells, %d colors, %d steps, %.6e s\n", ncells, 1, nsteps, elapsed);
 
 
   // Get the A result and check to make sure it worked!
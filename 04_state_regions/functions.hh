@@ -21,7 +21,6 @@
 struct FA
 {
   double operator()(double b, double c, double e, double h) const {
-    std::cout << "  Running FA";
     return 2 * b + c*e*h;
   }
   double dA_dB(double b, double c, double e, double h) const {
@@ -44,7 +43,6 @@ struct FA
 struct FC
 {
   double operator()(double d, double g) const {
-    std::cout << "  Running FC(" << d << "," << g << ")";
     return 2*d + g;
   }
   double dC_dD(double d, double g) const {
@@ -60,7 +58,6 @@ struct FC
 struct FD
 {
   double operator()(double g) const {
-    std::cout << "  Running FD";
     return 2*g;
   }
   double dD_dG(double g) const {
@@ -72,7 +69,6 @@ struct FD
 struct FE
 {
   double operator()(double d, double f) const {
-    std::cout << "  Running FE";
     return d*f;
   }
   double dE_dD(double d, double f) const {
@@ -89,7 +85,6 @@ struct FE
 struct FF
 {
   double operator()(double g) const {
-    std::cout << "  Running FF";
     return 2.*g;
   }
   double dF_dG(double g) const {
@@ -102,7 +97,6 @@ struct FF
 struct FH
 {
   double operator()(double f) const {
-    std::cout << "  Running FH";
     return 2*f;
   }
   double dH_dF(double f) const {
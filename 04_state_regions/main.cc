@@ -1,3 +1,6 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
 #include <cmath>
 
@@ -32,44 +35,87 @@ void TestEvaluator(const Task *task,
   // in
   FieldID fid = *(task->regions[0].privilege_fields.begin());
   const Legion::FieldAccessor<READ_ONLY,double,1> fa(regions[0], fid);
+  double expected = *(const double*) task->args;
 
-  for (int i=0; i!=g_ncells; ++i) {
-    if (std::abs((double) fa[i] - 6484.0) > 1.e-10)
-      std::cout << "fail, fid(" << fid << "), i(" << i << "): " << (double) fa[i] << std::endl;
-    assert(std::abs((double) fa[i] - 6484.0) < 1.e-10);
+  auto domain = runtime->get_index_space_domain(ctx, task->regions[0].region.get_index_space());
+  for (Legion::PointInRectIterator<1> p(domain); p(); ++p) {
+    if (std::abs((double) fa[*p] - expected) > 1.e-10)
+      std::cout << "fail, fid(" << fid << "), i(" << *p << "): " << (double) fa[*p] << std::endl;
+    assert(std::abs((double) fa[*p] - expected) < 1.e-10);
   }
   printf("Successful test!\n");
 }
 
 
 
+// the value following flag on the command line, or def
+static const char* InputArg(const char* flag, const char* def)
+{
+  const InputArgs& args = Runtime::get_input_args();
+  for (int i = 1; i < args.argc - 1; ++i)
+    if (!strcmp(args.argv[i], flag)) return args.argv[i+1];
+  return def;
+}
+
+// the value of each key of the DAG, the same everywhere
+static double Expected(const std::string& key)
+{
+  static const std::map<std::string,double> values = {
+    {"A", 6484.}, {"B", 2.}, {"C", 15.}, {"D", 6.},
+    {"E", 36.}, {"F", 6.}, {"G", 3.}, {"H", 12.} };
+  if (!values.count(key)) {
+    std::cout << "-dag must be one of the keys A-H, not " << key << std::endl;
+    throw("bad -dag");
+  }
+  return values.at(key);
+}
+
+
 void top_level_task(const Task *task,
                     const std::vector<PhysicalRegion> &regions,
                     Context ctx, HighLevelRuntime *runtime)
 {
-  State s(ctx, runtime);
+  int ncells = std::atoi(InputArg("-cells", "4"));
+  int nsteps = std::atoi(InputArg("-steps", "1"));
+  std::string key = InputArg("-dag", "A"); // the key, and so sub-DAG, to evaluate
+  double expected = Expected(key);
+
+  State s(ctx, runtime, ncells);
 
   // require primaries
   s.RequireEvaluator("B");
   s.RequireEvaluator("G");
 
-  // require top level A
-  s.RequireEvaluator("A");
+  // require the top level
+  s.RequireEvaluator(key);
 
   s.report(); // empty?
   s.Setup(); // create everything
   
   // go
-  s.evaluators["A"]->Update(s, "main");
+  auto start = std::chrono::steady_clock::now();
+  for (int step = 0; step != nsteps; ++step) {
+    // a new step changes the primaries, so everything is recomputed
+    if (step > 0) {
+      for (auto& eval : s.evaluators) {
+        auto primary = dynamic_cast<EvaluatorPrimary<TaskManagerPrimary<double> >*>(eval.second.get());
+        if (primary) primary->SetChanged();
+      }
+    }
+    s.evaluators[key]->Update(s, "main");
+  }
+  runtime->issue_execution_fence(ctx).get_void_result();
+  double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  printf("Timing: %d cells, %d colors, %d steps, %.6e s\n", ncells, 1, nsteps, elapsed);
 
   s.report(); // correct?
 
-  // Get the A result and check to make sure it worked!
+  // Get the result and check to make sure it worked!
   std::cout << "Launching Test Check Answer" << std::endl;
-  Legion::TaskLauncher Tlauncher(TEST_ID, TaskArgument(NULL, 0));
+  Legion::TaskLauncher Tlauncher(TEST_ID, TaskArgument(&expected, sizeof(double)));
   Tlauncher.add_region_requirement(
       RegionRequirement(s.logical_region, READ_ONLY, EXCLUSIVE, s.logical_region));
-  Tlauncher.add_field(0,s.field_ids.at("A"));
+  Tlauncher.add_field(0,s.field_ids.at(key));
   runtime->execute_task(ctx, Tlauncher);
   
   std::cout << "Test passed!" << std::endl;
@@ -17,15 +17,14 @@
 
 namespace Arcos {
 
-static const int g_ncells = 4;
-
 class Evaluator;
 
 struct State {
-  State(Legion::Context ctx_, Legion::Runtime *runtime_)
+  // a 1D domain of ncells cells
+  State(Legion::Context ctx_, Legion::Runtime *runtime_, int ncells)
     : ctx(ctx_),
       runtime(runtime_),
-      domain(Legion::DomainPoint(0), Legion::DomainPoint(g_ncells-1)),
+      domain(Legion::DomainPoint(0), Legion::DomainPoint(ncells-1)),
       n_fids(0)
   {}
 
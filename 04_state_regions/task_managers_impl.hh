@@ -82,7 +82,8 @@ TaskManagerPrimary<Data_t>::cpu_task(const Legion::Task *task,
   printf("Initializing (field %d) = %g\n", fid, val);
 
   const Legion::FieldAccessor<WRITE_DISCARD,double,1> acc(regions[0], fid);
-  for (int i=0; i!=g_ncells; ++i) acc[i] = val;
+  auto domain = runtime->get_index_space_domain(ctx, task->regions[0].region.get_index_space());
+  for (Legion::PointInRectIterator<1> p(domain); p(); ++p) acc[*p] = val;
 }
 
 template<typename Data_t>
@@ -123,7 +124,7 @@ TaskManagerSecondary<Func_t,Args...>
 
 
 template<typename Accessor_iter_t, typename T>
-T readAccessor(Accessor_iter_t& a, int i)
+T readAccessor(Accessor_iter_t& a, const Legion::Point<1>& i)
 {
   T t = (*a)[i];
   a++;
@@ -132,7 +133,7 @@ T readAccessor(Accessor_iter_t& a, int i)
 
 // read a vector of futures and return a tuple of their results
 template<typename Accessor_iter_t, typename... Args>
-std::tuple<Args...> accessorsToValues(Accessor_iter_t a, int i)
+std::tuple<Args...> accessorsToValues(Accessor_iter_t a, const Legion::Point<1>& i)
 {
   return std::make_tuple(readAccessor<Accessor_iter_t,Args>(a,i)...);
 }
@@ -166,11 +167,12 @@ TaskManagerSecondary<Func_t,Args...>
   const Legion::FieldAccessor<WRITE_DISCARD,double,1> fa_out(regions[0], *task->regions[0].privilege_fields.begin());
 
   // iterate and invoke the function
-  for (int i=0; i!=g_ncells; ++i) {
-    auto values = accessorsToValues<std::vector<Legion::FieldAccessor<READ_ONLY,double,1>>::const_iterator, Args...>(fas_in.begin(), i);
-    fa_out[i] = Arcos::Magic::invoke<double>(func, values);
-    std::cout << ", got: " << (double) fa_out[i] << std::endl;
+  auto domain = runtime->get_index_space_domain(ctx, task->regions[0].region.get_index_space());
+  for (Legion::PointInRectIterator<1> p(domain); p(); ++p) {
+    auto values = accessorsToValues<std::vector<Legion::FieldAccessor<READ_ONLY,double,1>>::const_iterator, Args...>(fas_in.begin(), *p);
+    fa_out[*p] = Arcos::Magic::invoke<double>(func, values);
   }
+  std::cout << " done." << std::endl;
 }
 
 
@@ -1,9 +1,12 @@
 
+#include <chrono>
 #include <cmath>
 #include <cstdio>
 #include <cassert>
 #include <cstdlib>
+#include <cstring>
 #include "legion.h"
+#include "default_mapper.h"
 using namespace Legion;
 
 /*
@@ -38,8 +41,26 @@ enum FieldIDs {
   FID_H
 };
 
-static const int g_ncells = 20;  // will need to figure this out sometime...
-static const int g_npartitions = 4;  // will need to figure this out sometime...
+// the value following flag on the command line, or def
+static const char* InputArg(const char* flag, const char* def)
+{
+  const InputArgs& args = Runtime::get_input_args();
+  for (int i = 1; i < args.argc - 1; ++i)
+    if (!strcmp(args.argv[i], flag)) return args.argv[i+1];
+  return def;
+}
+
+// whether -arcos:verbose was given, for a message per launch and task
+static bool Verbose()
+{
+  static const bool verbose = [] {
+    const InputArgs& args = Runtime::get_input_args();
+    for (int i = 1; i < args.argc; ++i)
+      if (!strcmp(args.argv[i], "-arcos:verbose")) return true;
+    return false;
+  }();
+  return verbose;
+}
 
 // Note, since all results are stored in regions, all tasks return an error
 // code.
@@ -56,7 +77,7 @@ void BEvaluator(const Task *task,
   // This is a field polymorphic function so figure out
   // which field we are responsible for initializing.
   FieldID fid = *(task->regions[0].privilege_fields.begin());
-  printf("Initializing B(field %d) = 2.0", fid);
+  if (Verbose()) printf("Initializing B(field %d) = 2.0", fid);
   assert(fid == FID_B);
 
   const FieldAccessor<WRITE_DISCARD,double,1> acc(regions[0], fid);
@@ -67,7 +88,7 @@ void BEvaluator(const Task *task,
     count++;
   }
 
-  printf(" on %d cells\n",count);
+  if (Verbose()) printf(" on %d cells\n",count);
 }
 
 
@@ -82,7 +103,7 @@ void GEvaluator(const Task *task,
   // This is a field polymorphic function so figure out
   // which field we are responsible for initializing.
   FieldID fid = *(task->regions[0].privilege_fields.begin());
-  printf("Initializing G (field %d) = 3.0\n", fid);
+  if (Verbose()) printf("Initializing G (field %d) = 3.0\n", fid);
   assert(fid == FID_G);
 
   const FieldAccessor<WRITE_DISCARD,double,1> acc(regions[0], fid);
@@ -112,7 +133,7 @@ void AEvaluator(const Task *task,
 
   auto domain = runtime->get_index_space_domain(ctx, task->regions[0].region.get_index_space());
   for (PointInRectIterator<1> p(domain); p(); p++) fa[*p] = 2*fb[*p] + fc[*p]*fe[*p]*fh[*p];
-  printf("Evaluating A = %g\n", (double) fa[0]);
+  if (Verbose()) printf("Evaluating A = %g\n", (double) fa[0]);
 }
 
 
@@ -134,7 +155,7 @@ void CEvaluator(const Task *task,
 
   auto domain = runtime->get_index_space_domain(ctx, task->regions[0].region.get_index_space());
   for (PointInRectIterator<1> p(domain); p(); p++) fc[*p] = 2 * fd[*p] + fg[*p];
-  printf("Evaluating C = %g\n", (double) fc[0]);
+  if (Verbose()) printf("Evaluating C = %g\n", (double) fc[0]);
 }
 
 
@@ -155,7 +176,7 @@ void DEvaluator(const Task *task,
 
   auto domain = runtime->get_index_space_domain(ctx, task->regions[0].region.get_index_space());
   for (PointInRectIterator<1> p(domain); p(); p++) fd[*p] = 2 * fg[*p];
-  printf("Evaluating D = %g\n", (double) fd[0]);
+  if (Verbose()) printf("Evaluating D = %g\n", (double) fd[0]);
 }
 
 void EEvaluator(const Task *task,
@@ -176,7 +197,7 @@ void EEvaluator(const Task *task,
 
   auto domain = runtime->get_index_space_domain(ctx, task->regions[0].region.get_index_space());
   for (PointInRectIterator<1> p(domain); p(); p++) fe[*p] = fd[*p] * ff[*p];
-  printf("Evaluating E = %g\n", (double) fe[0]);
+  if (Verbose()) printf("Evaluating E = %g\n", (double) fe[0]);
 }
 
 void FEvaluator(const Task *task,
@@ -196,7 +217,7 @@ void FEvaluator(const Task *task,
 
   auto domain = runtime->get_index_space_domain(ctx, task->regions[0].region.get_index_space());
   for (PointInRectIterator<1> p(domain); p(); p++) ff[*p] = 2 * fg[*p];
-  printf("Evaluating F = %g\n", (double) ff[0]);
+  if (Verbose()) printf("Evaluating F = %g\n", (double) ff[0]);
 }
 
 void HEvaluator(const Task *task,
@@ -216,7 +237,7 @@ void HEvaluator(const Task *task,
 
   auto domain = runtime->get_index_space_domain(ctx, task->regions[0].region.get_index_space());
   for (PointInRectIterator<1> p(domain); p(); p++) fh[*p] = 2 * ff[*p];
-  printf("Evaluating H = %g\n", (double) fh[0]);
+  if (Verbose()) printf("Evaluating H = %g\n", (double) fh[0]);
 }
 
 
@@ -246,9 +267,19 @@ void top_level_task(const Task *task,
                     Context ctx, Runtime *runtime)
 {
   std::cout << "Top Level Task" << std::endl;
+  int ncells = std::atoi(InputArg("-cells", "20"));
+  int nsteps = std::atoi(InputArg("-steps", "1"));
+
+  // the number of partitions: -colors, or else -colors_per_core (1) per core
+  int npartitions = std::atoi(InputArg("-colors", "0"));
+  if (npartitions <= 0) {
+    int ncores = runtime->select_tunable_value(ctx,
+            Mapping::DefaultMapper::DEFAULT_TUNABLE_GLOBAL_CPUS, 0).get_result<size_t>();
+    npartitions = ncores * std::atoi(InputArg("-colors_per_core", "1"));
+  }
 
-  // create a domain and index space of size g_ncells
-  const Rect<1> domain(DomainPoint(0), DomainPoint(g_ncells-1));
+  // create a domain and index space of size ncells
+  const Rect<1> domain(DomainPoint(0), DomainPoint(ncells-1));
   IndexSpace untyped_is = runtime->create_index_space(ctx, domain); 
   runtime->attach_name(untyped_is, "domain");
   printf("Created untyped index space %x\n", untyped_is.get_id());
@@ -290,7 +321,7 @@ void top_level_task(const Task *task,
       state_lr.get_tree_id());
 
   // create the partitioning
-  Rect<1> color_bounds(0, g_npartitions-1);
+  Rect<1> color_bounds(0, npartitions-1);
   IndexSpace color_is = runtime->create_index_space(ctx, color_bounds);
   runtime->attach_name(color_is, "coloring is");
 
@@ -322,89 +353,96 @@ void top_level_task(const Task *task,
   ArgumentMap arg_map;
   
   // launch task for B IC
-  std::cout << "Launching B" << std::endl;
-  IndexLauncher Blauncher(TID_B, color_is, TaskArgument(NULL, 0), arg_map);
-  Blauncher.add_region_requirement(
-      RegionRequirement(state_lp, 0, WRITE_DISCARD, EXCLUSIVE, state_lr));
-  Blauncher.add_field(0,FID_B);
-  runtime->execute_index_space(ctx, Blauncher);
-
-  // launch task for G IC
-  std::cout << "Launching G" << std::endl;
-  IndexLauncher Glauncher(TID_G, color_is, TaskArgument(NULL, 0), arg_map);
-  Glauncher.add_region_requirement(
-      RegionRequirement(state_lp, 0, WRITE_DISCARD, EXCLUSIVE, state_lr));
-  Glauncher.add_field(0,FID_G);
-  runtime->execute_index_space(ctx, Glauncher);
-
-  // second level launches
-  std::cout << "Launching D" << std::endl;
-  IndexLauncher Dlauncher(TID_D, color_is, TaskArgument(NULL, 0), arg_map);
-  Dlauncher.add_region_requirement(
-      RegionRequirement(state_lp, 0, WRITE_DISCARD, EXCLUSIVE, state_lr));
-  Dlauncher.add_field(0, FID_D); // 0 refers to the 0th region requirement?
-  Dlauncher.add_region_requirement(
-      RegionRequirement(state_lp, 0, READ_ONLY, EXCLUSIVE, state_lr));
-  Dlauncher.add_field(1, FID_G); // 0 refers to the 0th region requirement?
-  runtime->execute_index_space(ctx, Dlauncher);
-
-  std::cout << "Launching F" << std::endl;
-  IndexLauncher Flauncher(TID_F, color_is, TaskArgument(NULL, 0), arg_map);
-  Flauncher.add_region_requirement(
-      RegionRequirement(state_lp, 0, WRITE_DISCARD, EXCLUSIVE, state_lr));
-  Flauncher.add_field(0, FID_F); // 0 refers to the 0th region requirement?
-  Flauncher.add_region_requirement(
-      RegionRequirement(state_lp, 0, READ_ONLY, EXCLUSIVE, state_lr));
-  Flauncher.add_field(1, FID_G); // 0 refers to the 0th region requirement?
-  runtime->execute_index_space(ctx, Flauncher);
-
-  // third level launches
-  std::cout << "Launching C" << std::endl;
-  IndexLauncher Clauncher(TID_C, color_is, TaskArgument(NULL, 0), arg_map);
-  Clauncher.add_region_requirement(
-      RegionRequirement(state_lp, 0, WRITE_DISCARD, EXCLUSIVE, state_lr));
-  Clauncher.add_field(0, FID_C); // 0 refers to the 0th region requirement?
-  Clauncher.add_region_requirement(
-      RegionRequirement(state_lp, 0, READ_ONLY, EXCLUSIVE, state_lr));
-  Clauncher.add_field(1, FID_D); // 0 refers to the 0th region requirement?
-  Clauncher.add_field(1, FID_G); // 0 refers to the 0th region requirement?
-  runtime->execute_index_space(ctx, Clauncher);
+  auto start = std::chrono::steady_clock::now();
+  for (int step = 0; step != nsteps; ++step) {
+    if (Verbose()) std::cout << "Launching B" << std::endl;
+    IndexLauncher Blauncher(TID_B, color_is, TaskArgument(NULL, 0), arg_map);
+    Blauncher.add_region_requirement(
+        RegionRequirement(state_lp, 0, WRITE_DISCARD, EXCLUSIVE, state_lr));
+    Blauncher.add_field(0,FID_B);
+    runtime->execute_index_space(ctx, Blauncher);
+
+    // launch task for G IC
+    if (Verbose()) std::cout << "Launching G" << std::endl;
+    IndexLauncher Glauncher(TID_G, color_is, TaskArgument(NULL, 0), arg_map);
+    Glauncher.add_region_requirement(
+        RegionRequirement(state_lp, 0, WRITE_DISCARD, EXCLUSIVE, state_lr));
+    Glauncher.add_field(0,FID_G);
+    runtime->execute_index_space(ctx, Glauncher);
+
+    // second level launches
+    if (Verbose()) std::cout << "Launching D" << std::endl;
+    IndexLauncher Dlauncher(TID_D, color_is, TaskArgument(NULL, 0), arg_map);
+    Dlauncher.add_region_requirement(
+        RegionRequirement(state_lp, 0, WRITE_DISCARD, EXCLUSIVE, state_lr));
+    Dlauncher.add_field(0, FID_D); // 0 refers to the 0th region requirement?
+    Dlauncher.add_region_requirement(
+        RegionRequirement(state_lp, 0, READ_ONLY, EXCLUSIVE, state_lr));
+    Dlauncher.add_field(1, FID_G); // 0 refers to the 0th region requirement?
+    runtime->execute_index_space(ctx, Dlauncher);
+
+    if (Verbose()) std::cout << "Launching F" << std::endl;
+    IndexLauncher Flauncher(TID_F, color_is, TaskArgument(NULL, 0), arg_map);
+    Flauncher.add_region_requirement(
+        RegionRequirement(state_lp, 0, WRITE_DISCARD, EXCLUSIVE, state_lr));
+    Flauncher.add_field(0, FID_F); // 0 refers to the 0th region requirement?
+    Flauncher.add_region_requirement(
+        RegionRequirement(state_lp, 0, READ_ONLY, EXCLUSIVE, state_lr));
+    Flauncher.add_field(1, FID_G); // 0 refers to the 0th region requirement?
+    runtime->execute_index_space(ctx, Flauncher);
+
+    // third level launches
+    if (Verbose()) std::cout << "Launching C" << std::endl;
+    IndexLauncher Clauncher(TID_C, color_is, TaskArgument(NULL, 0), arg_map);
+    Clauncher.add_region_requirement(
+        RegionRequirement(state_lp, 0, WRITE_DISCARD, EXCLUSIVE, state_lr));
+    Clauncher.add_field(0, FID_C); // 0 refers to the 0th region requirement?
+    Clauncher.add_region_requirement(
+        RegionRequirement(state_lp, 0, READ_ONLY, EXCLUSIVE, state_lr));
+    Clauncher.add_field(1, FID_D); // 0 refers to the 0th region requirement?
+    Clauncher.add_field(1, FID_G); // 0 refers to the 0th region requirement?
+    runtime->execute_index_space(ctx, Clauncher);
   
-  // third level launches
-  std::cout << "Launching E" << std::endl;
-  IndexLauncher Elauncher(TID_E, color_is, TaskArgument(NULL, 0), arg_map);
-  Elauncher.add_region_requirement(
-      RegionRequirement(state_lp, 0, WRITE_DISCARD, EXCLUSIVE, state_lr));
-  Elauncher.add_field(0, FID_E); // 0 refers to the 0th region requirement?
-  Elauncher.add_region_requirement(
-      RegionRequirement(state_lp, 0, READ_ONLY, EXCLUSIVE, state_lr));
-  Elauncher.add_field(1, FID_D); // 0 refers to the 0th region requirement?
-  Elauncher.add_field(1, FID_F); // 0 refers to the 0th region requirement?
-  runtime->execute_index_space(ctx, Elauncher);
-
-  std::cout << "Launching H" << std::endl;
-  IndexLauncher Hlauncher(TID_H, color_is, TaskArgument(NULL, 0), arg_map);
-  Hlauncher.add_region_requirement(
-      RegionRequirement(state_lp, 0, WRITE_DISCARD, EXCLUSIVE, state_lr));
-  Hlauncher.add_field(0,FID_H);
-  Hlauncher.add_region_requirement(
-      RegionRequirement(state_lp, 0, READ_ONLY, EXCLUSIVE, state_lr));
-  Hlauncher.add_field(1, FID_F); // 0 refers to the 0th region requirement?
-  runtime->execute_index_space(ctx, Hlauncher);
-
-  // fourth level launches
-  std::cout << "Launching A" << std::endl;
-  IndexLauncher Alauncher(TID_A, color_is, TaskArgument(NULL, 0), arg_map);
-  Alauncher.add_region_requirement(
-      RegionRequirement(state_lp, 0, WRITE_DISCARD, EXCLUSIVE, state_lr));
-  Alauncher.add_field(0,FID_A);
-  Alauncher.add_region_requirement(
-      RegionRequirement(state_lp, 0, READ_ONLY, EXCLUSIVE, state_lr));
-  Alauncher.add_field(1, FID_B); // 0 refers to the 0th region requirement?
-  Alauncher.add_field(1, FID_C); // 0 refers to the 0th region requirement?
-  Alauncher.add_field(1, FID_E); // 0 refers to the 0th region requirement?
-  Alauncher.add_field(1, FID_H); // 0 refers to the 0th region requirement?
-  runtime->execute_index_space(ctx, Alauncher);
+    // third level launches
+    if (Verbose()) std::cout << "Launching E" << std::endl;
+    IndexLauncher Elauncher(TID_E, color_is, TaskArgument(NULL, 0), arg_map);
+    Elauncher.add_region_requirement(
+        RegionRequirement(state_lp, 0, WRITE_DISCARD, EXCLUSIVE, state_lr));
+    Elauncher.add_field(0, FID_E); // 0 refers to the 0th region requirement?
+    Elauncher.add_region_requirement(
+        RegionRequirement(state_lp, 0, READ_ONLY, EXCLUSIVE, state_lr));
+    Elauncher.add_field(1, FID_D); // 0 refers to the 0th region requirement?
+    Elauncher.add_field(1, FID_F); // 0 refers to the 0th region requirement?
+    runtime->execute_index_space(ctx, Elauncher);
+
+    if (Verbose()) std::cout << "Launching H" << std::endl;
+    IndexLauncher Hlauncher(TID_H, color_is, TaskArgument(NULL, 0), arg_map);
+    Hlauncher.add_region_requirement(
+        RegionRequirement(state_lp, 0, WRITE_DISCARD, EXCLUSIVE, state_lr));
+    Hlauncher.add_field(0,FID_H);
+    Hlauncher.add_region_requirement(
+        RegionRequirement(state_lp, 0, READ_ONLY, EXCLUSIVE, state_lr));
+    Hlauncher.add_field(1, FID_F); // 0 refers to the 0th region requirement?
+    runtime->execute_index_space(ctx, Hlauncher);
+
+    // fourth level launches
+    if (Verbose()) std::cout << "Launching A" << std::endl;
+    IndexLauncher Alauncher(TID_A, color_is, TaskArgument(NULL, 0), arg_map);
+    Alauncher.add_region_requirement(
+        RegionRequirement(state_lp, 0, WRITE_DISCARD, EXCLUSIVE, state_lr));
+    Alauncher.add_field(0,FID_A);
+    Alauncher.add_region_requirement(
+        RegionRequirement(state_lp, 0, READ_ONLY, EXCLUSIVE, state_lr));
+    Alauncher.add_field(1, FID_B); // 0 refers to the 0th region requirement?
+    Alauncher.add_field(1, FID_C); // 0 refers to the 0th region requirement?
+    Alauncher.add_field(1, FID_E); // 0 refers to the 0th region requirement?
+    Alauncher.add_field(1, FID_H); // 0 refers to the 0th region requirement?
+    runtime->execute_index_space(ctx, Alauncher);
+  }
+
+  runtime->issue_execution_fence(ctx).get_void_result();
+  double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  printf("Timing: %d cells, %d colors, %d steps, %.6e s\n", ncells, npartitions, nsteps, elapsed);
 
 
   // Get the A result and check to make sure it worked!
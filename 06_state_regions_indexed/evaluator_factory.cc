@@ -53,6 +53,26 @@ Evaluator_Factory::Create(const std::string& eval_type, State& s) {
     std::cout << "  ...creating an H evaluator." << std::endl;
     KeyList deps; deps.push_back("F");
     return std::make_unique<EvaluatorSecondary<TaskManagerSecondary<FH,double>, FH> >("H", deps, s);
+  } else if (eval_type == "dA") {
+    std::cout << "  ...creating a dA (face jump of A) evaluator." << std::endl;
+    KeyList deps; deps.push_back("A");
+    return std::make_unique<EvaluatorFaceSecondary<TaskManagerFace<FJump,double>, FJump> >("dA", deps, s);
+  } else if (eval_type == "sumA") {
+    std::cout << "  ...creating a sumA (sum of A) evaluator." << std::endl;
+    return std::make_unique<EvaluatorReduction<TaskManagerReduction<ReduceSum> > >("sumA", "A", s);
+  } else if (eval_type == "minA") {
+    std::cout << "  ...creating a minA (min of A) evaluator." << std::endl;
+    return std::make_unique<EvaluatorReduction<TaskManagerReduction<ReduceMin> > >("minA", "A", s);
+  } else if (eval_type == "maxA") {
+    std::cout << "  ...creating a maxA (max of A) evaluator." << std::endl;
+    return std::make_unique<EvaluatorReduction<TaskManagerReduction<ReduceMax> > >("maxA", "A", s);
+  } else if (eval_type == "l2A") {
+    std::cout << "  ...creating an l2A (L2 norm of A) evaluator." << std::endl;
+    return std::make_unique<EvaluatorReduction<TaskManagerReduction<ReduceL2> > >("l2A", "A", s);
+  } else if (eval_type == "nA") {
+    std::cout << "  ...creating an nA (A normalized by its max) evaluator." << std::endl;
+    KeyList deps; deps.push_back("A"); deps.push_back("maxA");
+    return std::make_unique<EvaluatorSecondary<TaskManagerSecondary<FNormalize,double,double>, FNormalize> >("nA", deps, s);
   } else {
     std::cout << "evaluator_factory passed bad argument " << eval_type << std::endl;
     throw("evaluator_factory passed bad argument");
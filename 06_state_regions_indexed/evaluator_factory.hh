@@ -10,7 +10,8 @@
 //
 //
 //  This only deals with evaluators A-H, as in Amanzi test example
-//  src/state/state_dag.cc
+//  src/state/state_dag.cc, the face jump dA, and reductions of A:
+//  sumA, minA, maxA, l2A, and nA = A / maxA.
 //  ---------------------------------------------------------------------------------
 
 #ifndef EVALUATORS_FACTORY_HH_
@@ -17,6 +17,9 @@
 //   * secondary variable evaluators:
 //	  interior nodes of the dag, these do some work to calculate their
 //        provided variable
+//   * reduction evaluators:
+//	  interior nodes of the dag, these reduce a field to a scalar
+//        (a sum, extremum, or norm), held as a future
 //
 //
 // Note this is a Legion-enabled mockup with some Arcos Evaluator
@@ -30,6 +33,8 @@
 #include <string>
 #include <set>
 #include "state.hh"
+#include "launch_plan.hh"
+#include "input_args.hh"
 
 namespace Arcos {
 
@@ -67,6 +72,46 @@ public:
   //   keys at the same time.  
   // -------------------------------------------------------------------------------
   virtual bool ProvidesKey(const Key& key) const = 0;
+
+  //
+  // Dependencies():
+  //
+  //   Forms the dag -- the keys this evaluator reads, in the order in
+  //   which they are passed to its function.
+  // -------------------------------------------------------------------------------
+  virtual KeyList Dependencies() const = 0;
+
+  //
+  // Location():
+  //
+  //   The mesh entity on which the provided key lives.
+  // -------------------------------------------------------------------------------
+  virtual Entity Location() const { return Entity::CELL; }
+
+  //
+  // Uniform():
+  //
+  //   Whether the provided key is the same everywhere, given what State
+  //   already holds as uniform, and if so its value.  Uniform keys may be
+  //   held by State as that value alone.
+  // -------------------------------------------------------------------------------
+  virtual bool Uniform(const State& S, double& value) const { return false; }
+
+  //
+  // LaunchEntry():
+  //
+  //   The index launch which computes this evaluator's key, as an entry
+  //   of State's launch plan.  Only valid after State::Setup().
+  // -------------------------------------------------------------------------------
+  virtual PlanEntry LaunchEntry(const State& S) const = 0;
+
+  //
+  // Launch():
+  //
+  //   Launches this evaluator's task, whether or not it is out of date
+  //   and without updating its dependencies.
+  // -------------------------------------------------------------------------------
+  virtual void Launch(State& S) = 0;
 };
 
 
@@ -91,6 +136,26 @@ public:
   // primary variables provide themselves only
   virtual bool ProvidesKey(const Key& key) const override;
 
+  // primary variables read nothing
+  virtual KeyList Dependencies() const override { return KeyList(); }
+
+  // primary variables are set to a single value
+  virtual bool Uniform(const State& S, double& value) const override {
+    value = value_;
+    return true;
+  }
+
+  // a launch filling the field with value_
+  virtual PlanEntry LaunchEntry(const State& S) const override;
+  virtual void Launch(State& S) override { Update_(S); }
+
+  // marks the primary as changed, e.g. at a new step, so that it is
+  // relaunched and everything depending upon it recomputed
+  void SetChanged() {
+    done_once_ = false;
+    requests_.clear();
+  }
+
 protected:
   void Update_(State& S);
   
@@ -128,8 +193,18 @@ public:
   // is key my key?
   virtual bool ProvidesKey(const Key& key) const override;
 
+  // my list of dependencies
+  virtual KeyList Dependencies() const override { return dependencies_; }
+
+  // a launch of my task manager
+  virtual PlanEntry LaunchEntry(const State& S) const override;
+
+  // uniform if all dependencies are, evaluated once on the host
+  virtual bool Uniform(const State& S, double& value) const override;
+  virtual void Launch(State& S) override { Update_(S); }
+
 protected:
-  void Update_(State& S);
+  virtual void Update_(State& S);
 
   Key key_;
   KeySet requests_;
@@ -139,6 +214,76 @@ protected:
 };
 
 
+//
+// Secondary variable evaluators on faces, reading cell dependencies on
+// both sides of each face (e.g. two-point fluxes).
+// =============================================================================
+template<typename TaskManager_t, typename Function_t>
+class EvaluatorFaceSecondary : public EvaluatorSecondary<TaskManager_t,Function_t> {
+public:
+  // constructor
+  EvaluatorFaceSecondary(Key key, KeyList deps, State& s)
+    : EvaluatorSecondary<TaskManager_t,Function_t>(std::move(key), std::move(deps), s) {}
+
+  // provides a face field
+  virtual Entity Location() const override { return Entity::FACE; }
+
+  // a launch over faces
+  virtual PlanEntry LaunchEntry(const State& S) const override;
+
+protected:
+  // launch over owned faces, reading the closure (owned + ghost) of cells
+  virtual void Update_(State& S) override;
+};
+
+
+
+//
+// Reduction evaluators, providing a scalar (a sum, extremum, or norm) of
+// a field.  The scalar is held by State as a future, and consumers are
+// passed that future, so nothing waits on the reduction.
+// =============================================================================
+template<typename TaskManager_t>
+class EvaluatorReduction : public Evaluator {
+public:
+  // constructor
+  EvaluatorReduction(Key key, Key dep, State& s)
+    : key_(std::move(key)),
+      dependency_(std::move(dep)) {
+    assert(dependency_ != key_);
+    s.RequireEvaluator(dependency_);
+  }
+
+  // update if needed
+  virtual bool Update(State& S, const Key& request) override;
+
+  // is key the field I reduce?
+  virtual bool IsDependency(const Key& key) const override { return key == dependency_; }
+
+  // is key my key?
+  virtual bool ProvidesKey(const Key& key) const override { return key == key_; }
+
+  // the field I reduce
+  virtual KeyList Dependencies() const override { return KeyList{dependency_}; }
+
+  // provides a scalar
+  virtual Entity Location() const override { return Entity::SCALAR; }
+
+  // uniform if the field is, evaluated once on the host
+  virtual bool Uniform(const State& S, double& value) const override;
+
+  // a reduction launch of my task manager
+  virtual PlanEntry LaunchEntry(const State& S) const override;
+  virtual void Launch(State& S) override { Update_(S); }
+
+protected:
+  void Update_(State& S);
+
+  Key key_;
+  KeySet requests_;
+  Key dependency_;
+};
+
 
 } // namespace Arcos  
   
@@ -44,7 +44,7 @@ EvaluatorPrimary<TaskManager_t>::ProvidesKey(const Key& key) const {
 template<typename TaskManager_t>
 bool
 EvaluatorPrimary<TaskManager_t>::Update(State& S, const Key& request) {
-  std::cout << "Calling Primary::Update() on " << key_ << "..." << std::endl;
+  if (Verbose()) std::cout << "Calling Primary::Update() on " << key_ << "..." << std::endl;
   if (!done_once_) {
     Update_(S);
     done_once_ = true;
@@ -58,15 +58,36 @@ EvaluatorPrimary<TaskManager_t>::Update(State& S, const Key& request) {
 }
 
 
+template<typename TaskManager_t>
+PlanEntry
+EvaluatorPrimary<TaskManager_t>::LaunchEntry(const State& S) const {
+  PlanEntry entry = PlanEntry();
+  entry.kind = LaunchKind::PRIMARY;
+  entry.taskid = TaskManager_t::taskid;
+  entry.out_fid = S.field_ids.at(key_);
+  entry.out_group = S.group_ids.at(key_);
+  entry.nargs = 0;
+  entry.value = value_;
+  entry.uniform = S.uniform.count(key_) > 0;
+  entry.priority = S.Priority(key_);
+  return entry;
+}
+
+
 // start the task, store the future
 template<typename TaskManager_t>
 void
 EvaluatorPrimary<TaskManager_t>::Update_(State& S) {
-  std::cout << "Launching Primary task for " << key_ << std::endl;
-  Legion::IndexLauncher launcher(TaskManager_t::taskid, S.partition, Legion::TaskArgument(&value_, sizeof(value_)), Legion::ArgumentMap());
-  launcher.add_region_requirement(Legion::RegionRequirement(S.logical_partition, 0, WRITE_DISCARD, EXCLUSIVE, S.logical_region));
-  launcher.add_field(0, S.field_ids.at(key_));  
-  S.futures[key_] = S.runtime->execute_index_space(S.ctx, launcher);
+  if (S.uniform.count(key_)) {
+    if (Verbose()) std::cout << "Primary " << key_ << " is uniform, nothing to launch" << std::endl;
+    return;
+  }
+  if (Verbose()) std::cout << "Launching Primary task for " << key_ << std::endl;
+  PlanEntry entry = LaunchEntry(S);
+  Legion::IndexLauncher launcher(entry.taskid, S.partition, PlanArgument(entry), Legion::ArgumentMap());
+  launcher.tag = PriorityTag(entry.priority);
+  AddRequirements(entry, launcher, S.GroupPartitions(), S.GroupRegions());
+  S.RecordLaunch(key_, S.runtime->execute_index_space(S.ctx, launcher));
 }
 
 
@@ -88,7 +109,7 @@ EvaluatorSecondary<TaskManager_t,Function_t>::ProvidesKey(const Key& key) const
 template<typename TaskManager_t, typename Function_t>
 bool
 EvaluatorSecondary<TaskManager_t,Function_t>::Update(State& S, const Key& request) {
-  std::cout << "Calling Secondary::Update() on " << key_ << "..." << std::endl;
+  if (Verbose()) std::cout << "Calling Secondary::Update() on " << key_ << "..." << std::endl;
   bool update = false;
 
   for (auto dep : dependencies_)
@@ -108,25 +129,199 @@ EvaluatorSecondary<TaskManager_t,Function_t>::Update(State& S, const Key& reques
 }
 
 
+template<typename TaskManager_t, typename Function_t>
+PlanEntry
+EvaluatorSecondary<TaskManager_t,Function_t>::LaunchEntry(const State& S) const {
+  assert(dependencies_.size() <= ARCOS_MAX_ARGS);
+  PlanEntry entry = PlanEntry();
+  entry.kind = LaunchKind::SECONDARY;
+  entry.taskid = TaskManager_t::taskid;
+  entry.out_fid = S.field_ids.at(key_);
+  entry.out_group = S.group_ids.at(key_);
+  entry.nargs = dependencies_.size();
+  for (int i = 0; i != entry.nargs; ++i) {
+    const Key& dep = dependencies_[i];
+    entry.arg_uniform[i] = S.uniform.count(dep) > 0;
+    entry.arg_scalar[i] = !entry.arg_uniform[i] && S.entities.at(dep) == Entity::SCALAR;
+    entry.arg_values[i] = entry.arg_uniform[i] ? S.uniform.at(dep) : 0.;
+    entry.arg_fids[i] = S.field_ids.count(dep) ? S.field_ids.at(dep) : 0;
+    entry.arg_groups[i] = S.group_ids.count(dep) ? S.group_ids.at(dep) : -1;
+  }
+  entry.uniform = S.uniform.count(key_) > 0;
+  entry.value = entry.uniform ? S.uniform.at(key_) : 0.;
+  entry.priority = S.Priority(key_);
+  return entry;
+}
+
+
+template<typename TaskManager_t, typename Function_t>
+bool
+EvaluatorSecondary<TaskManager_t,Function_t>::Uniform(const State& S, double& value) const {
+  std::vector<double> values;
+  for (const auto& dep : dependencies_) {
+    auto u = S.uniform.find(dep);
+    if (u == S.uniform.end()) return false;
+    values.push_back(u->second);
+  }
+  value = TaskManager_t::evaluate(values);
+  return true;
+}
+
+
 template<typename TaskManager_t, typename Function_t>
 void
 EvaluatorSecondary<TaskManager_t,Function_t>::Update_(State& S) {
-  std::cout << "Launching Secondary task for " << key_ << std::endl;
-
-  Legion::IndexLauncher launcher(TaskManager_t::taskid, S.partition, Legion::TaskArgument(NULL, 0), Legion::ArgumentMap());
-  launcher.add_region_requirement(Legion::RegionRequirement(S.logical_partition, 0, WRITE_DISCARD, EXCLUSIVE, S.logical_region));
-  launcher.add_field(0, S.field_ids.at(key_));
-  auto rr = Legion::RegionRequirement{S.logical_partition, 0, READ_ONLY, EXCLUSIVE, S.logical_region};
-  std::vector<Legion::FieldID> rr_deps;
-  for (auto dep : dependencies_) rr_deps.push_back(S.field_ids.at(dep));
-  rr.add_fields(rr_deps);
-  launcher.add_region_requirement(rr);
-  // for (auto dep : dependencies_) {
-  //   std::cout << "      adding field " << S.field_ids[dep] << std::endl;
-  //   launcher.add_field(1, S.field_ids[dep]);
-  // }
-  
-  S.futures[key_] = S.runtime->execute_index_space(S.ctx, launcher);
+  if (S.uniform.count(key_)) {
+    if (Verbose()) std::cout << "Secondary " << key_ << " is uniform, nothing to launch" << std::endl;
+    return;
+  }
+  if (Verbose()) std::cout << "Launching Secondary task for " << key_ << std::endl;
+
+  // The entry is passed to the task so that it can find the arguments'
+  // field IDs regardless of which region requirement (and therefore
+  // field group) they come from, and the values of uniform arguments.
+  PlanEntry entry = LaunchEntry(S);
+  Legion::IndexLauncher launcher(entry.taskid, S.partition, PlanArgument(entry), Legion::ArgumentMap());
+  launcher.tag = PriorityTag(entry.priority);
+  AddRequirements(entry, launcher, S.GroupPartitions(), S.GroupRegions());
+  S.AddScalars(dependencies_, launcher);
+  S.RecordLaunch(key_, S.runtime->execute_index_space(S.ctx, launcher));
+}
+
+
+// --------------------------------------------------------------------------------
+
+template<typename TaskManager_t, typename Function_t>
+PlanEntry
+EvaluatorFaceSecondary<TaskManager_t,Function_t>::LaunchEntry(const State& S) const {
+  PlanEntry entry = EvaluatorSecondary<TaskManager_t,Function_t>::LaunchEntry(S);
+  entry.kind = LaunchKind::FACE;
+  return entry;
+}
+
+
+template<typename TaskManager_t, typename Function_t>
+void
+EvaluatorFaceSecondary<TaskManager_t,Function_t>::Update_(State& S) {
+  const Key& key = this->key_;
+  const KeyList& deps = this->dependencies_;
+  if (S.uniform.count(key)) {
+    if (Verbose()) std::cout << "Face Secondary " << key << " is uniform, nothing to launch" << std::endl;
+    return;
+  }
+  if (Verbose()) std::cout << "Launching Face Secondary task for " << key << std::endl;
+  assert(S.mesh);
+
+  for (auto dep : deps) assert(S.entities.at(dep) != Entity::FACE);
+
+  PlanEntry entry = LaunchEntry(S);
+  Legion::IndexLauncher launcher(entry.taskid, S.partition, PlanArgument(entry),
+          Legion::ArgumentMap());
+  launcher.tag = PriorityTag(entry.priority);
+
+  // the output, on owned faces
+  const FieldGroup& out_group = S.Group(key);
+  launcher.add_region_requirement(Legion::RegionRequirement(out_group.logical_partition, 0, WRITE_DISCARD, EXCLUSIVE, out_group.logical_region));
+  launcher.add_field(0, S.field_ids.at(key));
+
+  // the adjacency of owned faces
+  auto topo_lp = S.runtime->get_logical_partition(S.ctx, S.mesh->topology, S.mesh->face_partition);
+  launcher.add_region_requirement(Legion::RegionRequirement(topo_lp, 0, READ_ONLY, EXCLUSIVE, S.mesh->topology));
+  launcher.add_field(1, FID_FACE_CELL0);
+  launcher.add_field(1, FID_FACE_CELL1);
+
+  // the dependencies, on owned and ghost cells
+  std::map<int,std::vector<Legion::FieldID> > group_fids;
+  for (auto dep : deps)
+    if (!S.uniform.count(dep) && S.entities.at(dep) == Entity::CELL)
+      group_fids[S.group_ids.at(dep)].push_back(S.field_ids.at(dep));
+  for (const auto& gf : group_fids) {
+    const FieldGroup& group = S.field_groups[gf.first];
+    auto closure_lp = S.runtime->get_logical_partition(S.ctx, group.logical_region, S.mesh->closure_partition);
+    auto rr = Legion::RegionRequirement{closure_lp, 0, READ_ONLY, EXCLUSIVE, group.logical_region};
+    rr.add_fields(gf.second);
+    launcher.add_region_requirement(rr);
+  }
+  S.AddScalars(deps, launcher);
+
+  S.RecordLaunch(key, S.runtime->execute_index_space(S.ctx, launcher));
+}
+
+
+// --------------------------------------------------------------------------------
+
+template<typename TaskManager_t>
+bool
+EvaluatorReduction<TaskManager_t>::Update(State& S, const Key& request) {
+  if (Verbose()) std::cout << "Calling Reduction::Update() on " << key_ << "..." << std::endl;
+  if (S.evaluators[dependency_]->Update(S,key_)) {
+    Update_(S);
+    requests_.clear();
+    requests_.insert(request);
+    return true;
+  } else if (requests_.find(request) == requests_.end()) {
+    requests_.insert(request);
+    return true;
+  } else {
+    return false;
+  }
+}
+
+
+template<typename TaskManager_t>
+bool
+EvaluatorReduction<TaskManager_t>::Uniform(const State& S, double& value) const {
+  auto u = S.uniform.find(dependency_);
+  if (u == S.uniform.end()) return false;
+  double n = S.entities.at(dependency_) == Entity::CELL ?
+      S.domain.get_volume() : S.mesh->face_cells.size();
+  value = TaskManager_t::evaluate(u->second, n);
+  return true;
+}
+
+
+template<typename TaskManager_t>
+PlanEntry
+EvaluatorReduction<TaskManager_t>::LaunchEntry(const State& S) const {
+  assert(S.entities.at(dependency_) != Entity::SCALAR);
+  PlanEntry entry = PlanEntry();
+  entry.kind = LaunchKind::REDUCTION;
+  entry.taskid = TaskManager_t::taskid;
+  entry.out_fid = 0;
+  entry.out_group = -1;
+
+  // the field is always read, even if uniform, as it is what gives the
+  // task its tile
+  entry.nargs = 1;
+  entry.arg_uniform[0] = false;
+  entry.arg_scalar[0] = false;
+  entry.arg_fids[0] = S.field_ids.at(dependency_);
+  entry.arg_groups[0] = S.group_ids.at(dependency_);
+  entry.uniform = S.uniform.count(key_) > 0;
+  entry.value = entry.uniform ? S.uniform.at(key_) : 0.;
+  entry.priority = S.Priority(key_);
+  return entry;
+}
+
+
+// start the reduction, store the future; this does not wait on it
+template<typename TaskManager_t>
+void
+EvaluatorReduction<TaskManager_t>::Update_(State& S) {
+  if (S.uniform.count(key_)) {
+    if (Verbose()) std::cout << "Reduction " << key_ << " is uniform, nothing to launch" << std::endl;
+    return;
+  }
+  if (Verbose()) std::cout << "Launching Reduction task for " << key_ << std::endl;
+  S.Materialize(dependency_);
+
+  PlanEntry entry = LaunchEntry(S);
+  Legion::IndexLauncher launcher(entry.taskid, S.partition, PlanArgument(entry), Legion::ArgumentMap());
+  launcher.tag = PriorityTag(entry.priority);
+  AddRequirements(entry, launcher, S.GroupPartitions(), S.GroupRegions());
+  auto launch = S.runtime->execute_index_space(S.ctx, launcher);
+  S.RecordLaunch(key_, launch);
+  S.scalars[key_] = TaskManager_t::reduce(S.ctx, S.runtime, launch);
 }
 
 
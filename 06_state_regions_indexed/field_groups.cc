@@ -0,0 +1,138 @@
+//! --------------------------------------------------------------------------------
+//
+// Arcos -- Legion
+//
+// Author: Ethan Coon (coonet@ornl.gov)
+// License: BSD
+//
+// Co-access analysis of State's fields.
+//
+// ---------------------------------------------------------------------------------
+
+#include <algorithm>
+#include "field_groups.hh"
+
+namespace Arcos {
+
+std::vector<std::vector<std::string> >
+GroupByCoAccess(const std::map<std::string, std::vector<std::string> >& reads,
+                const std::vector<std::string>& keys,
+                int max_group_size)
+{
+  // index the keys
+  std::map<std::string,int> index;
+  for (const auto& key : keys) {
+    if (index.count(key) == 0) {
+      int i = index.size();
+      index[key] = i;
+    }
+  }
+  int n = index.size();
+
+  // affinity[i][j] is the number of evaluators that read both i and j
+  std::vector<std::vector<int> > affinity(n, std::vector<int>(n, 0));
+  for (const auto& eval : reads) {
+    const auto& deps = eval.second;
+    for (size_t a = 0; a != deps.size(); ++a) {
+      for (size_t b = a+1; b != deps.size(); ++b) {
+        auto ia = index.find(deps[a]);
+        auto ib = index.find(deps[b]);
+        if (ia == index.end() || ib == index.end() || ia->second == ib->second) continue;
+        affinity[ia->second][ib->second]++;
+        affinity[ib->second][ia->second]++;
+      }
+    }
+  }
+
+  // start with one group per key; keys are indexed in order of first
+  // appearance in keys, and group i holds key i
+  std::vector<std::vector<int> > groups(n);
+  for (const auto& key : index) groups[key.second].push_back(key.second);
+
+  // greedily merge the pair of groups with the largest affinity
+  while (true) {
+    int best = 0;
+    int best_a = -1, best_b = -1;
+    for (int a = 0; a != (int) groups.size(); ++a) {
+      for (int b = a+1; b != (int) groups.size(); ++b) {
+        if (max_group_size > 0 &&
+            (int) (groups[a].size() + groups[b].size()) > max_group_size) continue;
+
+        int aff = 0;
+        for (int i : groups[a])
+          for (int j : groups[b]) aff += affinity[i][j];
+        if (aff > best) {
+          best = aff; best_a = a; best_b = b;
+        }
+      }
+    }
+    if (best_a < 0) break;
+
+    groups[best_a].insert(groups[best_a].end(), groups[best_b].begin(), groups[best_b].end());
+    groups.erase(groups.begin() + best_b);
+  }
+
+  // translate back to keys
+  std::vector<std::string> names(n);
+  for (const auto& key : index) names[key.second] = key.first;
+
+  std::vector<std::vector<std::string> > result;
+  for (auto& group : groups) {
+    std::sort(group.begin(), group.end());
+    std::vector<std::string> group_keys;
+    for (int i : group) group_keys.push_back(names[i]);
+    result.emplace_back(std::move(group_keys));
+  }
+  return result;
+}
+
+
+std::map<std::string, std::string>
+AliasByLiveness(const std::vector<std::string>& order,
+                const std::map<std::string, std::vector<std::string> >& reads,
+                const std::vector<std::string>& keys,
+                const std::set<std::string>& persistent)
+{
+  std::map<std::string,int> written;
+  for (int i = 0; i != (int) order.size(); ++i) written[order[i]] = i;
+
+  // the launch of the last read of each key
+  std::map<std::string,int> last_read;
+  for (const auto& key : order) {
+    auto deps = reads.find(key);
+    if (deps == reads.end()) continue;
+    for (const auto& dep : deps->second)
+      last_read[dep] = std::max(last_read[dep], written.at(key));
+  }
+
+  std::map<std::string, std::string> alias;
+  for (const auto& key : keys) alias[key] = key;
+
+  // linear scan in launch order, with a pool of storage whose last
+  // reader has already been launched
+  std::vector<std::pair<int, std::string> > live; // (last read, storage)
+  std::vector<std::string> free_storage;
+  for (int i = 0; i != (int) order.size(); ++i) {
+    const auto& key = order[i];
+    if (alias.count(key) == 0 || persistent.count(key)) continue;
+
+    for (auto l = live.begin(); l != live.end(); ) {
+      if (l->first < i) {
+        free_storage.push_back(l->second);
+        l = live.erase(l);
+      } else {
+        ++l;
+      }
+    }
+
+    if (!free_storage.empty()) {
+      alias[key] = free_storage.back();
+      free_storage.pop_back();
+    }
+    auto lr = last_read.find(key);
+    live.emplace_back(lr == last_read.end() ? i : lr->second, alias[key]);
+  }
+  return alias;
+}
+
+} // namespace Arcos
@@ -0,0 +1,75 @@
+//! --------------------------------------------------------------------------------
+//
+// Arcos -- Legion
+//
+// Author: Ethan Coon (coonet@ornl.gov)
+// License: BSD
+//
+// Co-access analysis of State's fields.
+//
+// Each evaluator reads a (small) set of fields together.  Fields which
+// are frequently read by the same evaluators are placed in the same
+// field space, and therefore in the same logical region and physical
+// instance, so that an evaluator's inputs stream from as few instances
+// (and cache lines and pages) as possible.  Fields which are never read
+// together end up in different field spaces, so that a kernel reading
+// four of several hundred fields does not drag the rest along.
+//
+// Liveness analysis lets intermediate fields share storage.  Given the
+// order in which fields are computed, a field is live from the launch
+// that writes it to the last launch that reads it, and fields whose
+// live ranges do not overlap may use the same field ID, much like
+// registers.  Peak storage then scales with the width of the DAG
+// rather than with its number of keys.
+//
+// ---------------------------------------------------------------------------------
+
+#ifndef ARCOS_FIELD_GROUPS_HH_
+#define ARCOS_FIELD_GROUPS_HH_
+
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace Arcos {
+
+//
+// Groups keys by co-access.
+//
+//   reads:          for each evaluator, the list of keys it reads together
+//   keys:           all keys that need storage
+//   max_group_size: maximum number of keys in a group (<= 0 for no limit)
+//
+// Greedily merges the pair of groups with the largest number of shared
+// reads until no pair with a positive affinity fits in a group.  Keys
+// that are never read together with another key end up alone.  The
+// result is deterministic for a given input.
+// -------------------------------------------------------------------------------
+std::vector<std::vector<std::string> >
+GroupByCoAccess(const std::map<std::string, std::vector<std::string> >& reads,
+                const std::vector<std::string>& keys,
+                int max_group_size);
+
+//
+// Assigns storage to keys by liveness.
+//
+//   order:      the keys in the order in which they are computed
+//   reads:      for each evaluator, the list of keys it reads
+//   keys:       the keys to consider, which may share storage
+//   persistent: keys which must keep their own storage, e.g. because
+//               they are observed outside of the DAG
+//
+// Returns, for each of keys, the key whose storage it uses (itself if
+// it is not aliased).  A key reuses the storage of another only if
+// that key's last read comes strictly before this key is written.
+// -------------------------------------------------------------------------------
+std::map<std::string, std::string>
+AliasByLiveness(const std::vector<std::string>& order,
+                const std::map<std::string, std::vector<std::string> >& reads,
+                const std::vector<std::string>& keys,
+                const std::set<std::string>& persistent);
+
+} // namespace Arcos
+
+#endif
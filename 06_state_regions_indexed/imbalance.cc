@@ -0,0 +1,86 @@
+//! --------------------------------------------------------------------------------
+//
+// Arcos -- Legion
+//
+// Author: Ethan Coon (coonet@ornl.gov)
+// License: BSD
+//
+// Load imbalance statistics of the colors of a launch.
+//
+// ---------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <limits>
+#include <sstream>
+#include "imbalance.hh"
+
+namespace Arcos {
+
+Imbalance
+MeasureImbalance(const std::map<Legion::DomainPoint, double>& times, int nbins)
+{
+  assert(nbins > 0);
+  Imbalance imb;
+  imb.min = std::numeric_limits<double>::max();
+  imb.max = 0.;
+  imb.mean = 0.;
+  for (const auto& ct : times) {
+    imb.min = std::min(imb.min, ct.second);
+    imb.max = std::max(imb.max, ct.second);
+    imb.mean += ct.second;
+  }
+  if (times.empty()) imb.min = 0.;
+  else imb.mean /= times.size();
+  imb.ratio = imb.mean > 0. ? imb.max / imb.mean : 1.;
+
+  imb.histogram.assign(nbins, 0);
+  double width = (imb.max - imb.min) / nbins;
+  for (const auto& ct : times) {
+    int bin = width > 0. ? (int) ((ct.second - imb.min) / width) : 0;
+    imb.histogram[std::min(bin, nbins-1)]++;
+  }
+  return imb;
+}
+
+
+std::vector<Legion::DomainPoint>
+Stragglers(const std::map<Legion::DomainPoint, double>& times, double threshold)
+{
+  double mean = 0.;
+  for (const auto& ct : times) mean += ct.second;
+  if (!times.empty()) mean /= times.size();
+
+  std::vector<Legion::DomainPoint> stragglers;
+  for (const auto& ct : times)
+    if (mean > 0. && ct.second > threshold * mean) stragglers.push_back(ct.first);
+  return stragglers;
+}
+
+
+void
+PrintImbalance(const std::string& label, const Imbalance& imb)
+{
+  printf("  %s: min %.4e  mean %.4e  max %.4e  imbalance (max/mean) %.3f\n",
+         label.c_str(), imb.min, imb.mean, imb.max, imb.ratio);
+  int nbins = imb.histogram.size();
+  int most = *std::max_element(imb.histogram.begin(), imb.histogram.end());
+  double width = (imb.max - imb.min) / nbins;
+  for (int b = 0; b != nbins; ++b) {
+    int bar = most > 0 ? (40 * imb.histogram[b] + most - 1) / most : 0;
+    printf("    [%.4e, %.4e) %6d %s\n", imb.min + b*width, imb.min + (b+1)*width,
+           imb.histogram[b], std::string(bar, '#').c_str());
+  }
+}
+
+
+std::string
+ColorString(const Legion::DomainPoint& color)
+{
+  std::stringstream ss;
+  ss << "(";
+  for (int d = 0; d != color.get_dim(); ++d) ss << (d ? "," : "") << color[d];
+  ss << ")";
+  return ss.str();
+}
+
+} // namespace Arcos
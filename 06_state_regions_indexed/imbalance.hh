@@ -0,0 +1,49 @@
+//! --------------------------------------------------------------------------------
+//
+// Arcos -- Legion
+//
+// Author: Ethan Coon (coonet@ornl.gov)
+// License: BSD
+//
+// Load imbalance statistics of the colors of a launch.
+//
+// The mean time per color hides the colors that hold up a step.  These
+// summarize the distribution of per-color times: its extremes, the
+// imbalance ratio (max / mean, 1 when perfectly balanced), and a
+// histogram, and find the colors well above the mean.
+//
+// ---------------------------------------------------------------------------------
+
+#ifndef ARCOS_IMBALANCE_HH_
+#define ARCOS_IMBALANCE_HH_
+
+#include <map>
+#include <string>
+#include <vector>
+#include "legion.h"
+
+namespace Arcos {
+
+struct Imbalance {
+  double min, max, mean;
+  double ratio;               // max / mean
+  std::vector<int> histogram; // counts of colors in equal bins over [min, max]
+};
+
+// statistics of the time of each color, with nbins histogram bins
+Imbalance
+MeasureImbalance(const std::map<Legion::DomainPoint, double>& times, int nbins);
+
+// the colors whose time exceeds threshold times the mean
+std::vector<Legion::DomainPoint>
+Stragglers(const std::map<Legion::DomainPoint, double>& times, double threshold);
+
+// prints the statistics and histogram, one line per bin, under a label
+void PrintImbalance(const std::string& label, const Imbalance& imbalance);
+
+// a color as (i,j,k)
+std::string ColorString(const Legion::DomainPoint& color);
+
+} // namespace Arcos
+
+#endif
@@ -0,0 +1,45 @@
+//! --------------------------------------------------------------------------------
+//
+// Arcos -- Legion
+//
+// Author: Ethan Coon (coonet@ornl.gov)
+// License: BSD
+//
+// Options from the command line, alongside Legion's own.
+//
+// ---------------------------------------------------------------------------------
+
+#include <cstring>
+#include "legion.h"
+#include "input_args.hh"
+
+namespace Arcos {
+
+const char*
+InputArg(const char* flag, const char* def)
+{
+  const Legion::InputArgs& args = Legion::Runtime::get_input_args();
+  for (int i = 1; i < args.argc - 1; ++i)
+    if (!std::strcmp(args.argv[i], flag)) return args.argv[i+1];
+  return def;
+}
+
+
+bool
+InputFlag(const char* flag)
+{
+  const Legion::InputArgs& args = Legion::Runtime::get_input_args();
+  for (int i = 1; i < args.argc; ++i)
+    if (!std::strcmp(args.argv[i], flag)) return true;
+  return false;
+}
+
+
+bool
+Verbose()
+{
+  static const bool verbose = InputFlag("-arcos:verbose");
+  return verbose;
+}
+
+} // namespace Arcos
@@ -0,0 +1,32 @@
+//! --------------------------------------------------------------------------------
+//
+// Arcos -- Legion
+//
+// Author: Ethan Coon (coonet@ornl.gov)
+// License: BSD
+//
+// Options from the command line, alongside Legion's own.  These may be
+// called from any task, on any thread; options that are read often
+// should be kept in a function-local static, whose initialization is
+// thread safe.
+//
+// ---------------------------------------------------------------------------------
+
+#ifndef ARCOS_INPUT_ARGS_HH_
+#define ARCOS_INPUT_ARGS_HH_
+
+namespace Arcos {
+
+// the value following flag on the command line, or def
+const char* InputArg(const char* flag, const char* def);
+
+// whether flag is on the command line
+bool InputFlag(const char* flag);
+
+// whether -arcos:verbose was given, for a message per update, launch,
+// and task
+bool Verbose();
+
+} // namespace Arcos
+
+#endif
@@ -0,0 +1,51 @@
+//! --------------------------------------------------------------------------------
+//
+// Arcos -- Legion
+//
+// Author: Ethan Coon (coonet@ornl.gov)
+// License: BSD
+//
+// A launch plan is the evaluator DAG flattened into a list of index
+// launches, in dependency order.
+//
+// ---------------------------------------------------------------------------------
+
+#include <map>
+#include "launch_plan.hh"
+
+namespace Arcos {
+
+Legion::TaskArgument
+PlanArgument(const PlanEntry& entry)
+{
+  if (entry.kind == LaunchKind::PRIMARY) {
+    return Legion::TaskArgument(&entry.value, sizeof(entry.value));
+  } else {
+    return Legion::TaskArgument(&entry, sizeof(PlanEntry));
+  }
+}
+
+
+void
+AddRequirements(const PlanEntry& entry, Legion::IndexLauncher& launcher,
+                const std::vector<Legion::LogicalPartition>& partitions,
+                const std::vector<Legion::LogicalRegion>& parents)
+{
+  if (entry.out_group >= 0) {
+    launcher.add_region_requirement(Legion::RegionRequirement(partitions[entry.out_group], 0,
+            WRITE_DISCARD, EXCLUSIVE, parents[entry.out_group]));
+    launcher.add_field(0, entry.out_fid);
+  }
+
+  // one read-only requirement per field group touched by the arguments
+  std::map<int,std::vector<Legion::FieldID> > group_fids;
+  for (int i = 0; i != entry.nargs; ++i)
+    if (!entry.arg_uniform[i] && !entry.arg_scalar[i]) group_fids[entry.arg_groups[i]].push_back(entry.arg_fids[i]);
+  for (const auto& gf : group_fids) {
+    auto rr = Legion::RegionRequirement{partitions[gf.first], 0, READ_ONLY, EXCLUSIVE, parents[gf.first]};
+    rr.add_fields(gf.second);
+    launcher.add_region_requirement(rr);
+  }
+}
+
+} // namespace Arcos
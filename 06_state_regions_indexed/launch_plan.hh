@@ -0,0 +1,86 @@
+//! --------------------------------------------------------------------------------
+//
+// Arcos -- Legion
+//
+// Author: Ethan Coon (coonet@ornl.gov)
+// License: BSD
+//
+// A launch plan is the evaluator DAG flattened into a list of index
+// launches, in dependency order.  Each entry is plain old data, so that
+// the plan (or part of it) can be passed as a task argument and replayed
+// by an inner task on a sub-partition of State's domain.
+//
+// ---------------------------------------------------------------------------------
+
+#ifndef ARCOS_LAUNCH_PLAN_HH_
+#define ARCOS_LAUNCH_PLAN_HH_
+
+#include <vector>
+#include "legion.h"
+
+#define ARCOS_MAX_ARGS 8
+
+// priorities are carried in the high bits of a launch's mapping tag,
+// clear of the bits the default mapper uses
+#define ARCOS_PRIORITY_SHIFT 16
+#define ARCOS_MAX_PRIORITY 1000
+
+namespace Arcos {
+
+enum class LaunchKind { PRIMARY, SECONDARY, FACE, REDUCTION };
+
+struct PlanEntry {
+  LaunchKind kind;
+  Legion::TaskID taskid;
+
+  // the output, and the field group holding it; a reduction's output is
+  // a future, and its group is -1
+  Legion::FieldID out_fid;
+  int out_group;
+
+  // the arguments, in order, and the field groups holding them; uniform
+  // arguments have no field and are passed by value instead, and scalar
+  // arguments have no field and are passed as the launch's futures, in
+  // the order of the arguments
+  int nargs;
+  Legion::FieldID arg_fids[ARCOS_MAX_ARGS];
+  int arg_groups[ARCOS_MAX_ARGS];
+  bool arg_uniform[ARCOS_MAX_ARGS];
+  bool arg_scalar[ARCOS_MAX_ARGS];
+  double arg_values[ARCOS_MAX_ARGS];
+
+  // whether the output is uniform, and so held as value alone and not
+  // launched, and the value (of a primary, or any uniform output)
+  double value;
+  bool uniform;
+
+  // the scheduling priority, higher for launches on longer critical paths
+  int priority;
+};
+
+// the mapping tag carrying a priority, and back
+inline Legion::MappingTagID PriorityTag(int priority) {
+  return ((Legion::MappingTagID) priority) << ARCOS_PRIORITY_SHIFT;
+}
+inline int TagPriority(Legion::MappingTagID tag) {
+  return (int) (tag >> ARCOS_PRIORITY_SHIFT);
+}
+
+// the task argument of an entry: the value of a primary, or the entry
+// itself for a secondary
+Legion::TaskArgument PlanArgument(const PlanEntry& entry);
+
+//
+// Adds an entry's region requirements to a launcher: the output
+// (write-discard), if it is a field, then one read-only requirement per
+// field group read.  Uniform and scalar arguments need no requirement.
+// partitions[g] and parents[g] are the logical partition to launch over
+// and its parent region, for field group g.
+// -------------------------------------------------------------------------------
+void AddRequirements(const PlanEntry& entry, Legion::IndexLauncher& launcher,
+                     const std::vector<Legion::LogicalPartition>& partitions,
+                     const std::vector<Legion::LogicalRegion>& parents);
+
+} // namespace Arcos
+
+#endif
@@ -1,5 +1,10 @@
+#include <chrono>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
 #include <cmath>
+#include <algorithm>
+#include <random>
 
 //#define STRING_HOLDER(VAR) struct VAR { static const char* asString() { return #VAR; } } 
 
@@ -9,6 +14,9 @@
 #include "functions.hh"
 #include "task_managers.hh"
 #include "evaluators.hh"
+#include "mapper.hh"
+#include "reductions.hh"
+#include "input_args.hh"
 #include "UniqueHelpers.hh"
 
 
@@ -21,58 +29,240 @@ enum TaskIDList {
 };
 
 
-void TestEvaluator(const Task *task,
+// the error of a tile of dimension DIM against the expected value
+template<int DIM>
+static ErrorNorms TileErrors(const PhysicalRegion& region, FieldID fid,
+                             const Domain& domain, double expected)
+{
+  const Legion::FieldAccessor<READ_ONLY,double,DIM> fa(region, fid);
+  ErrorNorms norms = ErrorNormsReduction::identity;
+  for (Legion::PointInRectIterator<DIM> p(domain); p(); ++p) {
+    double error = fa[*p] - expected;
+    norms.max = std::max(norms.max, std::abs(error));
+    norms.sum_sq += error * error;
+    norms.count += 1;
+  }
+  return norms;
+}
+
+
+// The error of one color's tile against the expected value, reduced
+// with those of all other colors into a single future.
+ErrorNorms TestEvaluator(const Task *task,
 		  const std::vector<PhysicalRegion> &regions,
 		  Context ctx, Runtime *runtime)
 {
-  std::cout << "Checking final answer:" << std::endl;
   assert(regions.size() == 1);
   assert(task->regions.size() == 1);
   assert(task->regions[0].privilege_fields.size() == 1);
 
   // in
   FieldID fid = *(task->regions[0].privilege_fields.begin());
-  const Legion::FieldAccessor<READ_ONLY,double,1> fa(regions[0], fid);
+  double expected = *(const double*) task->args;
 
   auto domain = runtime->get_index_space_domain(ctx, task->regions[0].region.get_index_space());
-  for (Legion::PointInRectIterator<1> p(domain); p(); ++p) {
-    std::cout << "  - Checking point " << *p - *Legion::PointInRectIterator<1>(domain) << " = " << fa[*p] << " (expected 6484.0)" << std::endl;
-    assert(std::abs(fa[*p] - 6484.0) < 1.e-10);
+  switch (domain.get_dim()) {
+    case 1: return TileErrors<1>(regions[0], fid, domain, expected);
+#if ARCOS_MAX_DIM >= 2
+    case 2: return TileErrors<2>(regions[0], fid, domain, expected);
+#endif
+#if ARCOS_MAX_DIM >= 3
+    case 3: return TileErrors<3>(regions[0], fid, domain, expected);
+#endif
+    default: assert(false);
+  }
+  return ErrorNormsReduction::identity;
+}
+
+
+// the extents of a structured domain, from "NX[,NY[,NZ]]"
+static std::vector<long long> ParseExtents(const char* arg)
+{
+  std::vector<long long> extents;
+  for (const char* c = arg; *c; ) {
+    char* end;
+    extents.push_back(std::strtoll(c, &end, 10));
+    if (end == c || extents.back() <= 0 || (*end && (*end != ',' || !end[1]))) {
+      std::cout << "-extents must be NX[,NY[,NZ]], not " << arg << std::endl;
+      throw("bad -extents");
+    }
+    c = *end ? end + 1 : end;
   }
-  printf("Successful test!\n");
+  if (extents.empty() || extents.size() > ARCOS_MAX_DIM) {
+    std::cout << "-extents must have 1 to " << ARCOS_MAX_DIM << " dimensions, not " << arg << std::endl;
+    throw("bad -extents");
+  }
+  return extents;
+}
+
+
+// the renumbering of -renumber: none, rcm, or morton
+static Renumbering ParseRenumbering(const std::string& arg)
+{
+  if (arg == "none") return Renumbering::NONE;
+  if (arg == "rcm") return Renumbering::RCM;
+  if (arg == "morton") return Renumbering::MORTON;
+  std::cout << "-renumber must be none, rcm, or morton, not " << arg << std::endl;
+  throw("bad -renumber");
 }
 
 
+// the value of each key of the DAG, the same everywhere
+static double Expected(const std::string& key)
+{
+  static const std::map<std::string,double> values = {
+    {"A", 6484.}, {"B", 2.}, {"C", 15.}, {"D", 6.},
+    {"E", 36.}, {"F", 6.}, {"G", 3.}, {"H", 12.}, {"nA", 1.}, {"dA", 0.} };
+  if (!values.count(key)) {
+    std::cout << "-dag must be one of the keys A-H, nA, or dA, not " << key << std::endl;
+    throw("bad -dag");
+  }
+  return values.at(key);
+}
+
 
 void top_level_task(const Task *task,
                     const std::vector<PhysicalRegion> &regions,
                     Context ctx, HighLevelRuntime *runtime)
 {
-  State s(ctx, runtime, 20); // 20 grid cells
+  int ncells = std::atoi(InputArg("-cells", "20"));
+  int nsteps = std::atoi(InputArg("-steps", "1"));
+  std::string key = InputArg("-dag", "A"); // the key, and so sub-DAG, to evaluate
+  double expected = Expected(key);
+
+  // a chain mesh of -cells cells (-mesh 1), a structured domain of
+  // -extents, or else a 1D one of -cells
+  bool mesh = std::atoi(InputArg("-mesh", "0")) != 0;
+  const char* extents = InputArg("-extents", nullptr);
+  if (mesh && extents) {
+    std::cout << "-mesh and -extents may not both be given" << std::endl;
+    throw("bad -mesh");
+  }
+  Renumbering renumbering = ParseRenumbering(InputArg("-renumber", "none"));
+  if (renumbering != Renumbering::NONE && !mesh) {
+    std::cout << "-renumber requires -mesh 1" << std::endl;
+    throw("bad -renumber");
+  }
+
+  std::unique_ptr<State> state;
+  if (mesh) {
+    Mesh chain = Mesh::Chain(ncells);
+    if (renumbering != Renumbering::NONE) {
+      // shuffle the cells, as those of a mesh read from file might be,
+      // so that the renumbering has an order to recover
+      std::vector<long long> order(ncells);
+      for (long long c = 0; c != ncells; ++c) order[c] = c;
+      std::shuffle(order.begin(), order.end(), std::mt19937(0));
+      chain.Renumber(order);
+    }
+    state = std::make_unique<State>(ctx, runtime, std::move(chain));
+    state->renumbering = renumbering;
+  } else if (extents) {
+    state = std::make_unique<State>(ctx, runtime, ParseExtents(extents));
+  } else {
+    state = std::make_unique<State>(ctx, runtime, ncells);
+  }
+  State& s = *state;
+  s.colors = std::atoi(InputArg("-colors", "0"));
+  s.colors_per_core = std::atoi(InputArg("-colors_per_core", "1"));
+
+  // with -uniform 1 uniform keys are folded to a value rather than
+  // launched; the DAG depends only on uniform primaries, so then no
+  // evaluator task runs at all
+  s.uniform_primaries = std::atoi(InputArg("-uniform", "0")) != 0;
+  s.fold_uniform = s.uniform_primaries;
 
   // require primaries
   s.RequireEvaluator("B");
   s.RequireEvaluator("G");
 
-  // require top level A
-  s.RequireEvaluator("A");
+  // require the top level
+  s.RequireEvaluator(key);
+
+  // with -repartition KEY, the tiles are recut by the cost given by the
+  // cell field KEY before the run
+  const char* cost_key = InputArg("-repartition", nullptr);
+  if (cost_key) s.RequireEvaluator(cost_key);
+
+  // with -alias 1, intermediates share storage where their lifetimes
+  // allow, at the cost of relaunching the whole sub-DAG on each Update()
+  s.alias_intermediates = std::atoi(InputArg("-alias", "0")) != 0;
+
+  // with -rebalance N, every N steps the tiles are recut if the measured
+  // imbalance exceeds -rebalance_threshold
+  s.rebalance_window = std::atoi(InputArg("-rebalance", "0"));
+  s.rebalance_threshold = std::atof(InputArg("-rebalance_threshold", "1.25"));
+
+  // with -hierarchical 1, each Update() launches an inner task per coarse
+  // color (-coarse_colors, or one per node if 0), which replays the
+  // sub-DAG on its own tile; cell fields only, so not with -mesh or nA
+  s.hierarchical = std::atoi(InputArg("-hierarchical", "0")) != 0;
+  s.coarse_colors = std::atoi(InputArg("-coarse_colors", "0"));
+
+  // with -imbalance 1, each step ends by reporting the per-color task
+  // times of its launches, and any persistent stragglers
+  s.imbalance_report = std::atoi(InputArg("-imbalance", "0")) != 0;
 
   s.report(); // empty?
   s.Setup(); // create everything
-  
+
+  if (cost_key) {
+    if (s.entities.at(cost_key) != Entity::CELL) {
+      std::cout << "-repartition must name a cell field, not " << cost_key << std::endl;
+      throw("bad -repartition");
+    }
+    s.Update(cost_key);
+    s.Repartition(cost_key);
+  }
+
   // go
-  s.evaluators["A"]->Update(s, "main");
+  auto start = std::chrono::steady_clock::now();
+  for (int step = 0; step != nsteps; ++step) {
+    // a new step changes the primaries, so everything is recomputed
+    if (step > 0) {
+      for (auto& eval : s.evaluators) {
+        auto primary = dynamic_cast<EvaluatorPrimary<TaskManagerPrimary<double> >*>(eval.second.get());
+        if (primary) primary->SetChanged();
+      }
+    }
+    s.Update(key);
+    s.EndStep();
+  }
+  runtime->issue_execution_fence(ctx).get_void_result();
+  double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  printf("Timing: %lu cells, %lu colors, %d steps, %.6e s\n", s.domain.get_volume(),
+         runtime->get_index_space_domain(ctx, s.partition).get_volume(), nsteps, elapsed);
 
   s.report(); // correct?
 
-  // Get the A result and check to make sure it worked!
+  // with -dot FILE or -json FILE, the DAG is written out with its
+  // measured costs and critical path
+  const char* dot = InputArg("-dot", nullptr);
+  if (dot) s.WriteDot(dot);
+  const char* json = InputArg("-json", nullptr);
+  if (json) s.WriteJson(json);
+
+  // the DAG depends only on uniform primaries, so it may have been
+  // folded to a value
+  s.Materialize(key);
+
+  // Get the result and check to make sure it worked!  Each color checks
+  // its own tile, and the errors are reduced to one future.
   std::cout << "Launching Test Check Answer" << std::endl;
-  Legion::TaskLauncher Tlauncher(TEST_ID, TaskArgument(NULL, 0));
+  const FieldGroup& group = s.Group(key);
+  Legion::IndexLauncher Tlauncher(TEST_ID, s.partition, TaskArgument(&expected, sizeof(double)),
+          ArgumentMap());
   Tlauncher.add_region_requirement(
-      RegionRequirement(s.logical_region, READ_ONLY, EXCLUSIVE, s.logical_region));
-  Tlauncher.add_field(0,s.field_ids.at("A"));
-  runtime->execute_task(ctx, Tlauncher);
-  
+      RegionRequirement(group.logical_partition, 0, READ_ONLY, EXCLUSIVE, group.logical_region));
+  Tlauncher.add_field(0,s.field_ids.at(key));
+  ErrorNorms norms = runtime->execute_index_space(ctx, Tlauncher, ErrorNormsReduction::redop)
+      .get_result<ErrorNorms>();
+
+  std::cout << "Checked " << (long long) norms.count << " entries: max error " << norms.max
+            << ", L2 error " << std::sqrt(norms.sum_sq) << std::endl;
+  assert(norms.count == (s.entities.at(key) == Entity::FACE ?
+                         s.mesh->face_cells.size() : s.domain.get_volume()));
+  assert(norms.max < 1.e-10);
   std::cout << "Test passed!" << std::endl;
 }
   
@@ -84,6 +274,8 @@ const char* FD::name = "fd";
 const char* FE::name = "fe";
 const char* FF::name = "ff";
 const char* FH::name = "fh";
+const char* FJump::name = "fjump";
+const char* FNormalize::name = "fnormalize";
 
 int main(int argc, char **argv) {
   {
@@ -96,8 +288,9 @@ int main(int argc, char **argv) {
     TaskVariantRegistrar registrar(TEST_ID, "TestEvaluator");
     registrar.add_constraint(ProcessorConstraint(Processor::LOC_PROC));
     registrar.set_leaf();
-    Runtime::preregister_task_variant<TestEvaluator>(registrar, "TestEvaluator");
+    Runtime::preregister_task_variant<ErrorNorms,TestEvaluator>(registrar, "TestEvaluator");
   }
+  ErrorNormsReduction::preregister();
 
   TaskManagerPrimary<double>::preregister_task();
 
@@ -107,6 +300,15 @@ int main(int argc, char **argv) {
   TaskManagerSecondary<FE,double,double>::preregister_task();
   TaskManagerSecondary<FF,double>::preregister_task();
   TaskManagerSecondary<FH,double>::preregister_task();
+  TaskManagerFace<FJump,double>::preregister_task();
+  TaskManagerSecondary<FNormalize,double,double>::preregister_task();
+  TaskManagerReduction<ReduceSum>::preregister_task();
+  TaskManagerReduction<ReduceMin>::preregister_task();
+  TaskManagerReduction<ReduceMax>::preregister_task();
+  TaskManagerReduction<ReduceL2>::preregister_task();
+  TaskManagerInner::preregister_task();
+
+  ArcosMapper::Register();
   
   return Runtime::start(argc,argv);
 }
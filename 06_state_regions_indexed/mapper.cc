@@ -0,0 +1,184 @@
+//! --------------------------------------------------------------------------------
+//
+// Arcos -- Legion
+//
+// Author: Ethan Coon (coonet@ornl.gov)
+// License: BSD
+//
+// A mapper for State's launches.
+//
+// ---------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cstring>
+#include "mapper.hh"
+
+namespace Arcos {
+
+static bool
+ProcessorOrder_(const Legion::Processor& a, const Legion::Processor& b)
+{
+  if (a.address_space() != b.address_space()) return a.address_space() < b.address_space();
+  return a.id < b.id;
+}
+
+
+ArcosMapper::ArcosMapper(Legion::Mapping::MapperRuntime *rt, Legion::Machine machine,
+                         Legion::Processor local)
+  : Legion::Mapping::DefaultMapper(rt, machine, local, "arcos_mapper"),
+    stealing_(false)
+{
+  const Legion::InputArgs& args = Legion::Runtime::get_input_args();
+  for (int i = 1; i < args.argc; ++i)
+    if (!std::strcmp(args.argv[i], "-arcos:steal")) stealing_ = true;
+
+  Legion::Machine::ProcessorQuery cpus(machine);
+  cpus.only_kind(Legion::Processor::LOC_PROC);
+  for (auto p : cpus) {
+    global_cpus_.push_back(p);
+    if (p.address_space() == local.address_space()) node_cpus_.push_back(p);
+  }
+  std::sort(global_cpus_.begin(), global_cpus_.end(), ProcessorOrder_);
+  std::sort(node_cpus_.begin(), node_cpus_.end(), ProcessorOrder_);
+}
+
+
+static void
+CreateMappers_(Legion::Machine machine, Legion::Runtime *runtime,
+               const std::set<Legion::Processor>& local_procs)
+{
+  for (auto p : local_procs)
+    runtime->replace_default_mapper(new ArcosMapper(runtime->get_mapper_runtime(), machine, p), p);
+}
+
+
+void
+ArcosMapper::Register()
+{
+  Legion::Runtime::add_registration_callback(CreateMappers_);
+}
+
+
+void
+ArcosMapper::slice_task(const Legion::Mapping::MapperContext ctx,
+                        const Legion::Task& task,
+                        const SliceTaskInput& input,
+                        SliceTaskOutput& output)
+{
+  // launches from the top-level task (depth 1) span the machine, those
+  // from inner tasks stay on their node
+  bool node_local = task.get_depth() > 1;
+  const auto& cpus = node_local ? node_cpus_ : global_cpus_;
+
+  std::vector<long long> key;
+  for (int d = 0; d != input.domain.get_dim(); ++d) {
+    key.push_back(input.domain.lo()[d]);
+    key.push_back(input.domain.hi()[d]);
+  }
+  auto cached = slice_cache_.find(std::make_pair(key, node_local));
+  if (cached != slice_cache_.end()) {
+    output.slices = cached->second;
+    return;
+  }
+
+  // contiguous blocks of colors per processor, one slice per color so
+  // that nothing is moved (but see stealing)
+  long long npoints = input.domain.get_volume();
+  long long i = 0;
+  for (Legion::Domain::DomainPointIterator c(input.domain); c; c++, i++) {
+    Legion::Processor p = cpus[i * cpus.size() / npoints];
+    output.slices.push_back(TaskSlice(Legion::Domain(*c, *c), p, false, stealing_));
+  }
+  slice_cache_[std::make_pair(key, node_local)] = output.slices;
+}
+
+
+void
+ArcosMapper::map_task(const Legion::Mapping::MapperContext ctx,
+                      const Legion::Task& task,
+                      const MapTaskInput& input,
+                      MapTaskOutput& output)
+{
+  DefaultMapper::map_task(ctx, task, input, output);
+  output.task_priority = TagPriority(task.tag);
+}
+
+
+void
+ArcosMapper::default_policy_select_instance_fields(
+    Legion::Mapping::MapperContext ctx,
+    const Legion::RegionRequirement& req,
+    const std::set<Legion::FieldID>& needed_fields,
+    std::vector<Legion::FieldID>& fields)
+{
+  // every allocated field of the group, so that one instance serves all
+  // launches; uniform keys have no field until they are materialized
+  runtime->get_field_space_fields(ctx, req.region.get_field_space(), fields);
+}
+
+
+Legion::Memory
+ArcosMapper::default_policy_select_target_memory(
+    Legion::Mapping::MapperContext ctx,
+    Legion::Processor target_proc,
+    const Legion::RegionRequirement& req)
+{
+  // without NUMA memories, system memory as usual
+  Legion::Memory mem = SocketMemory_(target_proc);
+  if (!mem.exists())
+    return DefaultMapper::default_policy_select_target_memory(ctx, target_proc, req);
+  return mem;
+}
+
+
+void
+ArcosMapper::select_steal_targets(const Legion::Mapping::MapperContext ctx,
+                                  const SelectStealingInput& input,
+                                  SelectStealingOutput& output)
+{
+  if (!stealing_) return;
+  for (auto p : node_cpus_) {
+    if (p != local_proc && SameDomain_(p, local_proc) && !input.blacklist.count(p))
+      output.targets.insert(p);
+  }
+}
+
+
+void
+ArcosMapper::permit_steal_request(const Legion::Mapping::MapperContext ctx,
+                                  const StealRequestInput& input,
+                                  StealRequestOutput& output)
+{
+  if (!stealing_ || !SameDomain_(input.thief_proc, local_proc)) return;
+
+  // colors of index launches only, and at most half of what is waiting,
+  // so that the owner keeps most of its colors
+  std::vector<const Legion::Task*> colors;
+  for (auto task : input.stealable_tasks)
+    if (task->is_index_space) colors.push_back(task);
+  for (size_t i = 0; i < colors.size() / 2; ++i) output.stolen_tasks.insert(colors[i]);
+}
+
+
+Legion::Memory
+ArcosMapper::SocketMemory_(Legion::Processor proc)
+{
+  auto cached = socket_memory_.find(proc);
+  if (cached == socket_memory_.end()) {
+    Legion::Machine::MemoryQuery socket(machine);
+    socket.only_kind(Legion::Memory::SOCKET_MEM).has_affinity_to(proc);
+    Legion::Memory mem = socket.count() > 0 ? socket.first() : Legion::Memory::NO_MEMORY;
+    cached = socket_memory_.insert(std::make_pair(proc, mem)).first;
+  }
+  return cached->second;
+}
+
+
+bool
+ArcosMapper::SameDomain_(Legion::Processor a, Legion::Processor b)
+{
+  if (a.address_space() != b.address_space()) return false;
+  return SocketMemory_(a) == SocketMemory_(b);
+}
+
+} // namespace Arcos
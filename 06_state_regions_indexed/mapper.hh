@@ -0,0 +1,114 @@
+//! --------------------------------------------------------------------------------
+//
+// Arcos -- Legion
+//
+// Author: Ethan Coon (coonet@ornl.gov)
+// License: BSD
+//
+// A mapper for State's launches.
+//
+// Every evaluator is launched over the same color space, and color i of
+// one evaluator reads what color i of another wrote.  The default
+// mapper does not know this, and may run color i on a different
+// processor each time, copying its data between instances.  The Arcos
+// mapper instead:
+//
+//  * pins each color to one processor, the same for every launch over
+//    the same color space, by splitting the colors into contiguous
+//    blocks (so neighboring tiles share a processor)
+//  * makes instances that hold all of a field space's fields, so that
+//    every evaluator reading a field group finds the same instance
+//  * caches these decisions, so that later timesteps map for free
+//  * runs tasks in order of the priority State attaches to their
+//    launch, the length of the critical path they start
+//  * places each instance in the NUMA domain (Realm's SOCKET_MEM) of
+//    the processor that runs its color, when Realm provides one (run
+//    with -ll:nsize), so kernels stream from local memory.  Since the
+//    first launch to write a color runs on its pinned processor, pages
+//    are also first touched there.
+//
+// Launches from inner tasks (see State::hierarchical) are pinned to the
+// processors of the inner task's node.
+//
+// With -arcos:steal, idle processors may steal evaluator tasks, but only
+// from processors in the same NUMA domain (the same node, if Realm has
+// no NUMA memories), so the thief reads the same local instances.  A
+// stolen color goes back to its owner at the next launch, since slices
+// are always made for the owner.
+//
+// ---------------------------------------------------------------------------------
+
+#ifndef ARCOS_MAPPER_HH_
+#define ARCOS_MAPPER_HH_
+
+#include <map>
+#include <vector>
+#include "legion.h"
+#include "default_mapper.h"
+#include "launch_plan.hh"
+
+namespace Arcos {
+
+class ArcosMapper : public Legion::Mapping::DefaultMapper {
+ public:
+  ArcosMapper(Legion::Mapping::MapperRuntime *rt, Legion::Machine machine,
+              Legion::Processor local);
+
+  // replaces the default mapper on every processor; call before
+  // Runtime::start()
+  static void Register();
+
+  virtual void slice_task(const Legion::Mapping::MapperContext ctx,
+                          const Legion::Task& task,
+                          const SliceTaskInput& input,
+                          SliceTaskOutput& output) override;
+
+  virtual void map_task(const Legion::Mapping::MapperContext ctx,
+                        const Legion::Task& task,
+                        const MapTaskInput& input,
+                        MapTaskOutput& output) override;
+
+  virtual void select_steal_targets(const Legion::Mapping::MapperContext ctx,
+                                    const SelectStealingInput& input,
+                                    SelectStealingOutput& output) override;
+
+  virtual void permit_steal_request(const Legion::Mapping::MapperContext ctx,
+                                    const StealRequestInput& input,
+                                    StealRequestOutput& output) override;
+
+ protected:
+  virtual void default_policy_select_instance_fields(
+      Legion::Mapping::MapperContext ctx,
+      const Legion::RegionRequirement& req,
+      const std::set<Legion::FieldID>& needed_fields,
+      std::vector<Legion::FieldID>& fields) override;
+
+  virtual Legion::Memory default_policy_select_target_memory(
+      Legion::Mapping::MapperContext ctx,
+      Legion::Processor target_proc,
+      const Legion::RegionRequirement& req) override;
+
+  // the NUMA-local memory of a processor, or NO_MEMORY
+  Legion::Memory SocketMemory_(Legion::Processor proc);
+
+  // whether two processors share a NUMA domain
+  bool SameDomain_(Legion::Processor a, Legion::Processor b);
+
+  // CPUs of the whole machine and of this node, in a fixed order
+  std::vector<Legion::Processor> global_cpus_;
+  std::vector<Legion::Processor> node_cpus_;
+
+  // the NUMA-local memory of each processor, if any
+  std::map<Legion::Processor, Legion::Memory> socket_memory_;
+
+  // whether to steal within NUMA domains
+  bool stealing_;
+
+  // slices of each launch domain, for global and node-local launches
+  std::map<std::pair<std::vector<long long>,bool>,
+           std::vector<Legion::Mapping::Mapper::TaskSlice> > slice_cache_;
+};
+
+} // namespace Arcos
+
+#endif
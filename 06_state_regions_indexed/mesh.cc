@@ -0,0 +1,185 @@
+//! --------------------------------------------------------------------------------
+//
+// Arcos -- Legion
+//
+// Author: Ethan Coon (coonet@ornl.gov)
+// License: BSD
+//
+// A mockup of an unstructured mesh for use in State.
+//
+// ---------------------------------------------------------------------------------
+
+#include <algorithm>
+#include "mesh.hh"
+
+namespace Arcos {
+
+Mesh
+Mesh::Chain(long long ncells)
+{
+  Mesh m;
+  m.ncells = ncells;
+  m.face_cells.push_back({0, 0});
+  for (long long c = 0; c < ncells-1; ++c) m.face_cells.push_back({c, c+1});
+  m.face_cells.push_back({ncells-1, ncells-1});
+  for (long long c = 0; c != ncells; ++c) m.centroids.push_back({c + 0.5, 0., 0.});
+  for (long long c = 0; c != ncells; ++c) m.cell_ids.push_back(c);
+  for (long long f = 0; f != (long long) m.face_cells.size(); ++f) m.face_ids.push_back(f);
+  return m;
+}
+
+
+void
+Mesh::Renumber(const std::vector<long long>& order)
+{
+  assert((long long) order.size() == ncells);
+  if (cell_ids.empty())
+    for (long long c = 0; c != ncells; ++c) cell_ids.push_back(c);
+  if (face_ids.empty())
+    for (long long f = 0; f != (long long) face_cells.size(); ++f) face_ids.push_back(f);
+
+  std::vector<long long> new_of_old(ncells);
+  for (long long c = 0; c != ncells; ++c) new_of_old[order[c]] = c;
+
+  // cells
+  std::vector<long long> new_cell_ids(ncells);
+  for (long long c = 0; c != ncells; ++c) new_cell_ids[c] = cell_ids[order[c]];
+  cell_ids = std::move(new_cell_ids);
+
+  if (!centroids.empty()) {
+    std::vector<std::array<double,3> > new_centroids(ncells);
+    for (long long c = 0; c != ncells; ++c) new_centroids[c] = centroids[order[c]];
+    centroids = std::move(new_centroids);
+  }
+
+  // faces, sorted by their renumbered cells
+  for (auto& fc : face_cells) {
+    fc[0] = new_of_old[fc[0]];
+    fc[1] = new_of_old[fc[1]];
+  }
+  std::vector<long long> face_order(face_cells.size());
+  for (long long f = 0; f != (long long) face_order.size(); ++f) face_order[f] = f;
+  std::stable_sort(face_order.begin(), face_order.end(),
+                   [this](long long a, long long b) {
+                     return std::min(face_cells[a][0], face_cells[a][1]) <
+                         std::min(face_cells[b][0], face_cells[b][1]);
+                   });
+
+  std::vector<std::array<long long,2> > new_face_cells(face_cells.size());
+  std::vector<long long> new_face_ids(face_cells.size());
+  for (long long f = 0; f != (long long) face_order.size(); ++f) {
+    new_face_cells[f] = face_cells[face_order[f]];
+    new_face_ids[f] = face_ids[face_order[f]];
+  }
+  face_cells = std::move(new_face_cells);
+  face_ids = std::move(new_face_ids);
+}
+
+
+void
+Mesh::Setup(Legion::Context ctx, Legion::Runtime* runtime)
+{
+  long long nfaces = face_cells.size();
+  faces = runtime->create_index_space(ctx,
+          Legion::Domain(Legion::DomainPoint(0), Legion::DomainPoint(nfaces-1)));
+  runtime->attach_name(faces, "mesh faces");
+
+  topology_fs = runtime->create_field_space(ctx);
+  {
+    Legion::FieldAllocator allocator = runtime->create_field_allocator(ctx, topology_fs);
+    allocator.allocate_field(sizeof(Legion::Point<1>), FID_FACE_CELL0);
+    allocator.allocate_field(sizeof(Legion::Point<1>), FID_FACE_CELL1);
+  }
+  topology = runtime->create_logical_region(ctx, faces, topology_fs);
+  runtime->attach_name(topology, "mesh topology");
+  printf("  Created mesh topology with %lld cells and %lld faces\n", ncells, nfaces);
+
+  // fill the adjacency from the host copy
+  Legion::RegionRequirement req(topology, WRITE_DISCARD, EXCLUSIVE, topology);
+  req.add_field(FID_FACE_CELL0);
+  req.add_field(FID_FACE_CELL1);
+  Legion::PhysicalRegion pr = runtime->map_region(ctx, Legion::InlineLauncher(req));
+  pr.wait_until_valid();
+  {
+    const Legion::FieldAccessor<WRITE_DISCARD,Legion::Point<1>,1> c0(pr, FID_FACE_CELL0);
+    const Legion::FieldAccessor<WRITE_DISCARD,Legion::Point<1>,1> c1(pr, FID_FACE_CELL1);
+    for (long long f = 0; f != nfaces; ++f) {
+      c0[f] = Legion::Point<1>(face_cells[f][0]);
+      c1[f] = Legion::Point<1>(face_cells[f][1]);
+    }
+  }
+  runtime->unmap_region(ctx, pr);
+}
+
+
+void
+Mesh::Partition(Legion::Context ctx, Legion::Runtime* runtime,
+                Legion::IndexSpace cells, Legion::IndexPartition cell_partition,
+                Legion::IndexSpace colors)
+{
+  if (face_partition.exists()) DestroyPartitions(ctx, runtime);
+
+  // faces are owned by the owner of their first cell
+  face_partition = runtime->create_partition_by_preimage(ctx, cell_partition,
+          topology, topology, FID_FACE_CELL0, colors, DISJOINT_KIND);
+  runtime->attach_name(face_partition, "mesh face partition");
+  auto face_lp = runtime->get_logical_partition(ctx, topology, face_partition);
+
+  // all cells touched by a color's faces
+  auto across = runtime->create_partition_by_image(ctx, cells,
+          face_lp, topology, FID_FACE_CELL1, colors);
+  closure_partition = runtime->create_partition_by_union(ctx, cells,
+          cell_partition, across, colors, ALIASED_KIND);
+  runtime->attach_name(closure_partition, "mesh closure partition");
+
+  // ghosts are what is touched but not owned
+  ghost_partition = runtime->create_partition_by_difference(ctx, cells,
+          closure_partition, cell_partition, colors, ALIASED_KIND);
+  runtime->attach_name(ghost_partition, "mesh ghost partition");
+
+  // shared cells are owned cells in any color's ghosts
+  Legion::Domain one(Legion::DomainPoint(0), Legion::DomainPoint(0));
+  Legion::IndexSpace one_color = runtime->create_index_space(ctx, one);
+  auto all_ghosts_ip = runtime->create_pending_partition(ctx, cells, one_color);
+  auto all_ghosts = runtime->create_index_space_union(ctx, all_ghosts_ip,
+          Legion::DomainPoint(0), ghost_partition);
+
+  shared_partition = runtime->create_pending_partition(ctx, cells, colors, DISJOINT_KIND);
+  auto color_domain = runtime->get_index_space_domain(ctx, colors);
+  for (Legion::Domain::DomainPointIterator c(color_domain); c; c++) {
+    std::vector<Legion::IndexSpace> both = {
+      runtime->get_index_subspace(ctx, cell_partition, *c), all_ghosts };
+    runtime->create_index_space_intersection(ctx, shared_partition, *c, both);
+  }
+  runtime->attach_name(shared_partition, "mesh shared partition");
+
+  private_partition = runtime->create_partition_by_difference(ctx, cells,
+          cell_partition, shared_partition, colors, DISJOINT_KIND);
+  runtime->attach_name(private_partition, "mesh private partition");
+
+  runtime->destroy_index_partition(ctx, all_ghosts_ip);
+  runtime->destroy_index_space(ctx, one_color);
+}
+
+
+void
+Mesh::DestroyPartitions(Legion::Context ctx, Legion::Runtime* runtime)
+{
+  runtime->destroy_index_partition(ctx, face_partition);
+  runtime->destroy_index_partition(ctx, closure_partition);
+  runtime->destroy_index_partition(ctx, ghost_partition);
+  runtime->destroy_index_partition(ctx, shared_partition);
+  runtime->destroy_index_partition(ctx, private_partition);
+}
+
+
+void
+Mesh::Destroy(Legion::Context ctx, Legion::Runtime* runtime)
+{
+  if (face_partition.exists()) DestroyPartitions(ctx, runtime);
+  runtime->destroy_logical_region(ctx, topology);
+  runtime->destroy_field_space(ctx, topology_fs);
+  runtime->destroy_index_space(ctx, faces);
+}
+
+} // namespace Arcos
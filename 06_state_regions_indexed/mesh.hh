@@ -0,0 +1,94 @@
+//! --------------------------------------------------------------------------------
+//
+// Arcos -- Legion
+//
+// Author: Ethan Coon (coonet@ornl.gov)
+// License: BSD
+//
+// A mockup of an unstructured mesh for use in State.
+//
+// The mesh topology is given on the host as a list of faces and the
+// two cells adjacent to each face.  At Setup(), the faces become an
+// index space and the adjacency becomes a logical region, from which
+// Legion's dependent partitioning derives, for each color of the cell
+// partition:
+//
+//   * faces:   the faces owned by the color, those whose first cell it
+//              owns (preimage of the cell partition through cell0)
+//   * closure: all cells touched by the color's faces, owned plus ghost
+//              (own cells united with the image of faces through cell1)
+//   * ghost:   cells read by the color but owned by another color
+//   * shared:  owned cells which are a ghost of some other color
+//   * private: owned cells which no other color reads
+//
+// Evaluators which read across faces request the closure partition of
+// their inputs, and so get only the halo data they need.
+//
+// ---------------------------------------------------------------------------------
+
+#ifndef ARCOS_MESH_HH_
+#define ARCOS_MESH_HH_
+
+#include <array>
+#include <vector>
+#include "legion.h"
+
+namespace Arcos {
+
+// the mesh entity on which a field lives; a scalar (e.g. a norm of a
+// field) lives on none, and is held as a future rather than a field
+enum class Entity { CELL, FACE, SCALAR };
+
+enum MeshFieldIDs {
+  FID_FACE_CELL0,
+  FID_FACE_CELL1
+};
+
+struct Mesh {
+  // a chain of ncells cells with a boundary face at each end
+  static Mesh Chain(long long ncells);
+
+  // host-side topology: the cells on either side of each face.  Boundary
+  // faces list their one cell twice.  Centroids are optional, and only
+  // needed for geometric renumbering.
+  long long ncells;
+  std::vector<std::array<long long,2> > face_cells;
+  std::vector<std::array<double,3> > centroids;
+
+  // the original (input file) ID of each cell and face, which changes
+  // only when the mesh is renumbered.  Input and output go through these.
+  std::vector<long long> cell_ids;
+  std::vector<long long> face_ids;
+
+  // renumber cells, where order[new_id] = old_id.  Faces are then sorted
+  // by their (new) first cell so that sweeps over faces follow the cells.
+  // Must be called before Setup().
+  void Renumber(const std::vector<long long>& order);
+
+  // Legion-side topology, created by Setup()
+  Legion::IndexSpace faces;
+  Legion::FieldSpace topology_fs;
+  Legion::LogicalRegion topology;
+
+  Legion::IndexPartition face_partition;
+  Legion::IndexPartition closure_partition;
+  Legion::IndexPartition ghost_partition;
+  Legion::IndexPartition shared_partition;
+  Legion::IndexPartition private_partition;
+
+  // create the face index space and the topology region
+  void Setup(Legion::Context ctx, Legion::Runtime* runtime);
+
+  // derive the face, closure, ghost, shared, and private partitions from
+  // a partition of the cells, replacing any previously derived ones
+  void Partition(Legion::Context ctx, Legion::Runtime* runtime,
+                 Legion::IndexSpace cells, Legion::IndexPartition cell_partition,
+                 Legion::IndexSpace colors);
+  void DestroyPartitions(Legion::Context ctx, Legion::Runtime* runtime);
+
+  void Destroy(Legion::Context ctx, Legion::Runtime* runtime);
+};
+
+} // namespace Arcos
+
+#endif
@@ -0,0 +1,176 @@
+//! --------------------------------------------------------------------------------
+//
+// Arcos -- Legion
+//
+// Author: Ethan Coon (coonet@ornl.gov)
+// License: BSD
+//
+// Helpers for forming State's domain and its partitions.
+//
+// ---------------------------------------------------------------------------------
+
+#include <cstdio>
+#include <limits>
+#include "partitioning.hh"
+
+namespace Arcos {
+
+Legion::Domain
+StructuredDomain(const std::vector<long long>& extents)
+{
+  assert(extents.size() > 0 && extents.size() <= ARCOS_MAX_DIM);
+  Legion::DomainPoint lo, hi;
+  lo.dim = extents.size();
+  hi.dim = extents.size();
+  for (size_t i = 0; i != extents.size(); ++i) {
+    lo[i] = 0;
+    hi[i] = extents[i] - 1;
+  }
+  return Legion::Domain(lo, hi);
+}
+
+
+std::vector<long long>
+Extents(const Legion::Domain& domain)
+{
+  std::vector<long long> extents(domain.get_dim());
+  for (size_t i = 0; i != extents.size(); ++i)
+    extents[i] = domain.hi()[i] - domain.lo()[i] + 1;
+  return extents;
+}
+
+
+// recursively try every factorization of ncolors over dimensions d..
+static void
+BlockedColors_(const std::vector<long long>& extents, long long ncolors, int d,
+               std::vector<long long>& colors, double& best_area,
+               std::vector<long long>& best)
+{
+  if (d == (int) extents.size() - 1) {
+    colors[d] = ncolors;
+
+    // area of the cuts perpendicular to each dimension
+    double area = 0.;
+    for (size_t i = 0; i != extents.size(); ++i) {
+      // no more tiles than cells
+      if (colors[i] > extents[i]) return;
+      double face = 1.;
+      for (size_t j = 0; j != extents.size(); ++j)
+        if (j != i) face *= extents[j];
+      area += (colors[i] - 1) * face;
+    }
+    if (area < best_area) {
+      best_area = area;
+      best = colors;
+    }
+    return;
+  }
+
+  for (long long c = 1; c <= ncolors; ++c) {
+    if (ncolors % c) continue;
+    colors[d] = c;
+    BlockedColors_(extents, ncolors / c, d+1, colors, best_area, best);
+  }
+}
+
+
+std::vector<long long>
+BlockedColors(const std::vector<long long>& extents, long long ncolors)
+{
+  assert(extents.size() > 0);
+  std::vector<long long> colors(extents.size(), 1);
+  std::vector<long long> best;
+  double best_area = std::numeric_limits<double>::max();
+  BlockedColors_(extents, ncolors, 0, colors, best_area, best);
+  if (!best.empty()) return best;
+
+  // no factorization fits within the extents; use the most colors that
+  // do, as no more than one per cell, and say so, as reports and timings
+  // then give a count other than the one asked for
+  long long ncells = 1;
+  for (auto e : extents) ncells *= e;
+  long long n = std::min(ncolors - 1, ncells);
+  for (; best.empty(); --n)
+    BlockedColors_(extents, n, 0, colors, best_area, best);
+  printf("Warning: %lld colors do not tile the domain's extents; using %lld\n",
+         ncolors, n + 1);
+  return best;
+}
+
+
+std::vector<long long>
+WeightedCuts(const std::vector<double>& cost, long long npieces)
+{
+  long long n = cost.size();
+  assert(npieces > 0 && npieces <= n);
+
+  double total = 0.;
+  for (auto c : cost) total += c;
+
+  std::vector<long long> cuts(npieces+1);
+  cuts[0] = 0;
+  cuts[npieces] = n;
+  double sum = 0.;
+  long long i = 0;
+  for (long long p = 1; p != npieces; ++p) {
+    // advance until this piece has its share, leaving a cell for each
+    // remaining piece
+    double target = total * p / npieces;
+    long long lo = cuts[p-1] + 1;
+    long long hi = n - (npieces - p);
+    while (i < lo || (i < hi && sum + cost[i] / 2. < target)) sum += cost[i++];
+    cuts[p] = i;
+  }
+  return cuts;
+}
+
+
+std::map<Legion::DomainPoint, Legion::Domain>
+WeightedTiles(const Legion::Domain& domain, const std::vector<long long>& colors,
+              const std::vector<std::vector<double> >& marginals)
+{
+  int dim = domain.get_dim();
+  assert((int) colors.size() == dim && (int) marginals.size() == dim);
+
+  std::vector<std::vector<long long> > cuts(dim);
+  for (int d = 0; d != dim; ++d) cuts[d] = WeightedCuts(marginals[d], colors[d]);
+
+  std::map<Legion::DomainPoint, Legion::Domain> tiles;
+  Legion::Domain color_domain = StructuredDomain(colors);
+  for (Legion::Domain::DomainPointIterator c(color_domain); c; c++) {
+    Legion::DomainPoint lo, hi;
+    lo.dim = dim;
+    hi.dim = dim;
+    for (int d = 0; d != dim; ++d) {
+      lo[d] = domain.lo()[d] + cuts[d][(*c)[d]];
+      hi[d] = domain.lo()[d] + cuts[d][(*c)[d]+1] - 1;
+    }
+    tiles[*c] = Legion::Domain(lo, hi);
+  }
+  return tiles;
+}
+
+std::vector<std::vector<double> >
+TileMarginals(const Legion::Domain& domain,
+              const std::map<Legion::DomainPoint, Legion::Domain>& tiles,
+              const std::map<Legion::DomainPoint, double>& tile_costs)
+{
+  int dim = domain.get_dim();
+  auto extents = Extents(domain);
+  std::vector<std::vector<double> > marginals(dim);
+  for (int d = 0; d != dim; ++d) marginals[d].assign(extents[d], 0.);
+
+  for (const auto& tile : tiles) {
+    double cost = tile_costs.at(tile.first);
+    auto tile_extents = Extents(tile.second);
+    for (int d = 0; d != dim; ++d) {
+      // each slab of the tile gets an equal share
+      double share = cost / tile_extents[d];
+      for (long long i = tile.second.lo()[d]; i <= tile.second.hi()[d]; ++i)
+        marginals[d][i - domain.lo()[d]] += share;
+    }
+  }
+  return marginals;
+}
+
+} // namespace Arcos
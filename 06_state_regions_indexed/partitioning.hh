@@ -0,0 +1,76 @@
+//! --------------------------------------------------------------------------------
+//
+// Arcos -- Legion
+//
+// Author: Ethan Coon (coonet@ornl.gov)
+// License: BSD
+//
+// Helpers for forming State's domain and its partitions.
+//
+// Structured domains are rectilinear boxes of 1, 2, or 3 dimensions.
+// They are partitioned into blocked tiles, with the number of tiles in
+// each dimension chosen to minimize the total surface area between
+// tiles (and therefore the surface-to-volume ratio of each tile).
+//
+// When cells have uneven cost, the tile boundaries are moved so that
+// each tile has roughly the same total cost.
+//
+// ---------------------------------------------------------------------------------
+
+#ifndef ARCOS_PARTITIONING_HH_
+#define ARCOS_PARTITIONING_HH_
+
+#include <map>
+#include <vector>
+#include "legion.h"
+
+#define ARCOS_MAX_DIM 3
+
+namespace Arcos {
+
+// the box [0, extents[0]) x [0, extents[1]) x ...
+Legion::Domain StructuredDomain(const std::vector<long long>& extents);
+
+// the number of cells in each dimension of a box
+std::vector<long long> Extents(const Legion::Domain& domain);
+
+//
+// Factors ncolors into one factor per dimension, minimizing the total
+// area of the cuts between tiles.  Dimensions with more cells get more
+// tiles.  If no factorization fits within the extents, this warns and
+// uses the largest count below ncolors that does.
+// -------------------------------------------------------------------------------
+std::vector<long long>
+BlockedColors(const std::vector<long long>& extents, long long ncolors);
+
+//
+// Cuts a dimension of n cells into npieces contiguous, nonempty pieces of
+// roughly equal total cost, given the cost of each cell (or slab of
+// cells).  Returns the npieces+1 boundaries, from 0 to n.
+// -------------------------------------------------------------------------------
+std::vector<long long>
+WeightedCuts(const std::vector<double>& cost, long long npieces);
+
+//
+// Forms the tiles of a weighted, rectilinear blocked partition.  Each
+// dimension is cut independently by the marginal cost of its slabs
+// (the total cost of all cells with that coordinate), so tiles in the
+// same row share boundaries.  Returns the tile of each color.
+// -------------------------------------------------------------------------------
+std::map<Legion::DomainPoint, Legion::Domain>
+WeightedTiles(const Legion::Domain& domain, const std::vector<long long>& colors,
+              const std::vector<std::vector<double> >& marginals);
+
+//
+// Marginal costs of each dimension when the cost of each tile is known
+// (e.g. measured) but not that of its cells.  Each tile's cost is spread
+// evenly over its cells.
+// -------------------------------------------------------------------------------
+std::vector<std::vector<double> >
+TileMarginals(const Legion::Domain& domain,
+              const std::map<Legion::DomainPoint, Legion::Domain>& tiles,
+              const std::map<Legion::DomainPoint, double>& tile_costs);
+
+} // namespace Arcos
+
+#endif
@@ -0,0 +1,129 @@
+//! --------------------------------------------------------------------------------
+//
+// Arcos -- Legion
+//
+// Author: Ethan Coon (coonet@ornl.gov)
+// License: BSD
+//
+// Hardware performance counters around task bodies.
+//
+// ---------------------------------------------------------------------------------
+
+#include <cstdlib>
+#include <cstring>
+#include "legion.h"
+#include "perf_counters.hh"
+#include "input_args.hh"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Arcos {
+
+bool
+PerfCounters::Enabled()
+{
+  static const bool enabled = InputFlag("-arcos:perf");
+  return enabled;
+}
+
+
+PerfCounters&
+PerfCounters::Thread()
+{
+  static thread_local PerfCounters counters;
+  return counters;
+}
+
+
+#ifdef __linux__
+
+// a counter of this thread, user space only, initially disabled; -1 if
+// the kernel refuses it
+static int
+OpenCounter_(unsigned type, unsigned long long config)
+{
+  struct perf_event_attr attr;
+  std::memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = type;
+  attr.config = config;
+  attr.disabled = 1;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  return syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0);
+}
+
+
+PerfCounters::PerfCounters()
+{
+  fds_[CYCLES] = OpenCounter_(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES);
+  fds_[INSTRUCTIONS] = OpenCounter_(PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS);
+  fds_[LLC_MISSES] = OpenCounter_(PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES);
+  const char* fp_raw = std::getenv("ARCOS_PERF_FP_RAW");
+  fds_[FP_OPS] = fp_raw ? OpenCounter_(PERF_TYPE_RAW, std::strtoull(fp_raw, NULL, 0)) : -1;
+}
+
+
+PerfCounters::~PerfCounters()
+{
+  for (int i = 0; i != NCOUNTERS; ++i) if (fds_[i] >= 0) close(fds_[i]);
+}
+
+
+void
+PerfCounters::Start()
+{
+  for (int i = 0; i != NCOUNTERS; ++i) {
+    if (fds_[i] < 0) continue;
+    ioctl(fds_[i], PERF_EVENT_IOC_RESET, 0);
+    ioctl(fds_[i], PERF_EVENT_IOC_ENABLE, 0);
+  }
+}
+
+
+PerfSample
+PerfCounters::Stop()
+{
+  double counts[NCOUNTERS];
+  for (int i = 0; i != NCOUNTERS; ++i) {
+    counts[i] = -1.;
+    if (fds_[i] < 0) continue;
+    ioctl(fds_[i], PERF_EVENT_IOC_DISABLE, 0);
+    unsigned long long count;
+    if (read(fds_[i], &count, sizeof(count)) == sizeof(count)) counts[i] = count;
+  }
+  PerfSample sample;
+  sample.cycles = counts[CYCLES];
+  sample.instructions = counts[INSTRUCTIONS];
+  sample.llc_misses = counts[LLC_MISSES];
+  sample.fp_ops = counts[FP_OPS];
+  return sample;
+}
+
+#else
+
+PerfCounters::PerfCounters()
+{
+  for (int i = 0; i != NCOUNTERS; ++i) fds_[i] = -1;
+}
+
+PerfCounters::~PerfCounters() {}
+
+void
+PerfCounters::Start() {}
+
+PerfSample
+PerfCounters::Stop()
+{
+  PerfSample sample = {-1., -1., -1., -1.};
+  return sample;
+}
+
+#endif
+
+} // namespace Arcos
@@ -0,0 +1,58 @@
+//! --------------------------------------------------------------------------------
+//
+// Arcos -- Legion
+//
+// Author: Ethan Coon (coonet@ornl.gov)
+// License: BSD
+//
+// Hardware performance counters around task bodies, through Linux's
+// perf_event_open(2), so no tools beyond the kernel are needed.
+//
+// Counted, for the calling thread only: cycles, instructions, and
+// last-level cache misses.  There is no portable event for floating
+// point operations, so those are counted only if the raw event code
+// for this CPU is given in the environment, e.g. on Intel
+//
+//   ARCOS_PERF_FP_RAW=0x1fc7   (FP_ARITH_INST_RETIRED, all double widths)
+//
+// Counters are off unless the program is run with -arcos:perf.  The
+// kernel may also refuse them (see /proc/sys/kernel/perf_event_paranoid),
+// in which case samples are simply invalid.
+//
+// ---------------------------------------------------------------------------------
+
+#ifndef ARCOS_PERF_COUNTERS_HH_
+#define ARCOS_PERF_COUNTERS_HH_
+
+namespace Arcos {
+
+// counts over one task body; negative if not counted
+struct PerfSample {
+  double cycles;
+  double instructions;
+  double llc_misses;
+  double fp_ops;
+};
+
+class PerfCounters {
+ public:
+  // whether -arcos:perf was given
+  static bool Enabled();
+
+  // the counters of the calling thread, opened on first use
+  static PerfCounters& Thread();
+
+  void Start();
+  PerfSample Stop();
+
+ private:
+  PerfCounters();
+  ~PerfCounters();
+
+  enum { CYCLES, INSTRUCTIONS, LLC_MISSES, FP_OPS, NCOUNTERS };
+  int fds_[NCOUNTERS];
+};
+
+} // namespace Arcos
+
+#endif
@@ -0,0 +1,33 @@
+//! --------------------------------------------------------------------------------
+//
+// Arcos -- Legion
+//
+// Author: Ethan Coon (coonet@ornl.gov)
+// License: BSD
+//
+// Reduction operators, for combining the results of every color of an
+// index launch into a single future.
+//
+// ---------------------------------------------------------------------------------
+
+#include "reductions.hh"
+
+namespace Arcos {
+
+const ErrorNorms ErrorNormsReduction::identity = {0., 0., 0.};
+Legion::ReductionOpID ErrorNormsReduction::redop = 0;
+
+void
+ErrorNormsReduction::preregister(Legion::ReductionOpID new_redop)
+{
+  redop = new_redop ? new_redop : Legion::Runtime::generate_static_reduction_id();
+  Legion::Runtime::register_reduction_op<ErrorNormsReduction>(redop);
+}
+
+
+const char* ReduceSum::name = "reduce_sum";
+const char* ReduceMin::name = "reduce_min";
+const char* ReduceMax::name = "reduce_max";
+const char* ReduceL2::name = "reduce_l2";
+
+} // namespace Arcos
@@ -0,0 +1,142 @@
+//! --------------------------------------------------------------------------------
+//
+// Arcos -- Legion
+//
+// Author: Ethan Coon (coonet@ornl.gov)
+// License: BSD
+//
+// Reduction operators, for combining the results of every color of an
+// index launch into a single future.
+//
+// A registered reduction (here, ErrorNormsReduction) is a struct as
+// Legion expects (LHS, RHS, identity, apply, fold), plus the ID it is
+// registered under:
+//
+// struct Reduction {
+//   static Legion::ReductionOpID redop;
+//   static void preregister(Legion::ReductionOpID new_redop = 0);
+// };
+//
+// preregister() must be called in main(), before the runtime starts.
+// The non-exclusive apply and fold may run concurrently on one target,
+// so they fold each member with AtomicFold.
+//
+// A global reduction of a field to a scalar (a sum, extremum, or norm)
+// pairs how entries combine with how each contributes and how the
+// combined result is finished.  Its tasks return TaskStats rather than
+// a bare double, so TaskManagerReduction registers, with each task, an
+// operator folding their values with Fold (its ValueReduction):
+//
+// struct Reduce {
+//   static double Identity();                  // of Fold
+//   static double Fold(double a, double b);    // combines entries and colors
+//   static double Map(double x);               // an entry's contribution
+//   static double Finish(double r);            // of the combined result
+//   static double Uniform(double x, double n); // of n entries all equal to x
+//   static const char* name;
+// };
+//
+// ---------------------------------------------------------------------------------
+
+#ifndef ARCOS_REDUCTIONS_HH_
+#define ARCOS_REDUCTIONS_HH_
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include "legion.h"
+
+namespace Arcos {
+
+// Folds value into target with op, as one atomic update of target.
+template<typename Op>
+inline void AtomicFold(double& target, double value, Op op) {
+  double expected;
+  __atomic_load(&target, &expected, __ATOMIC_RELAXED);
+  double desired = op(expected, value);
+  while (!__atomic_compare_exchange(&target, &expected, &desired, true,
+                                    __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+    desired = op(expected, value);
+}
+
+
+//
+// Norms of the error of a field against its expected value.
+// =============================================================================
+struct ErrorNorms {
+  double max;     // max |error|
+  double sum_sq;  // sum of error^2
+  double count;   // number of entries
+};
+
+struct ErrorNormsReduction {
+  typedef ErrorNorms LHS;
+  typedef ErrorNorms RHS;
+  static const ErrorNorms identity;
+
+  static Legion::ReductionOpID redop;
+  static void preregister(Legion::ReductionOpID new_redop = 0);
+
+  template<bool EXCLUSIVE> static void apply(LHS& lhs, RHS rhs) {
+    if (EXCLUSIVE) {
+      lhs.max = std::max(lhs.max, rhs.max);
+      lhs.sum_sq += rhs.sum_sq;
+      lhs.count += rhs.count;
+    } else {
+      // the members are independent, so each may be folded on its own
+      auto max = [](double a, double b) { return std::max(a, b); };
+      auto sum = [](double a, double b) { return a + b; };
+      AtomicFold(lhs.max, rhs.max, max);
+      AtomicFold(lhs.sum_sq, rhs.sum_sq, sum);
+      AtomicFold(lhs.count, rhs.count, sum);
+    }
+  }
+  template<bool EXCLUSIVE> static void fold(RHS& rhs1, RHS rhs2) {
+    apply<EXCLUSIVE>(rhs1, rhs2);
+  }
+};
+
+
+//
+// Global reductions of a field.
+// =============================================================================
+struct ReduceSum {
+  static double Identity() { return 0.; }
+  static double Fold(double a, double b) { return a + b; }
+  static double Map(double x) { return x; }
+  static double Finish(double r) { return r; }
+  static double Uniform(double x, double n) { return n * x; }
+  static const char* name;
+};
+
+struct ReduceMin {
+  static double Identity() { return std::numeric_limits<double>::max(); }
+  static double Fold(double a, double b) { return std::min(a, b); }
+  static double Map(double x) { return x; }
+  static double Finish(double r) { return r; }
+  static double Uniform(double x, double n) { return x; }
+  static const char* name;
+};
+
+struct ReduceMax {
+  static double Identity() { return std::numeric_limits<double>::lowest(); }
+  static double Fold(double a, double b) { return std::max(a, b); }
+  static double Map(double x) { return x; }
+  static double Finish(double r) { return r; }
+  static double Uniform(double x, double n) { return x; }
+  static const char* name;
+};
+
+// the L2 norm, sqrt(sum x^2)
+struct ReduceL2 {
+  static double Identity() { return 0.; }
+  static double Fold(double a, double b) { return a + b; }
+  static double Map(double x) { return x * x; }
+  static double Finish(double r) { return std::sqrt(r); }
+  static double Uniform(double x, double n) { return std::sqrt(n) * std::abs(x); }
+  static const char* name;
+};
+
+} // namespace Arcos
+
+#endif
@@ -0,0 +1,120 @@
+//! --------------------------------------------------------------------------------
+//
+// Arcos -- Legion
+//
+// Author: Ethan Coon (coonet@ornl.gov)
+// License: BSD
+//
+// Cell renumberings for locality.
+//
+// ---------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <queue>
+#include "renumbering.hh"
+
+namespace Arcos {
+
+std::vector<long long>
+ReverseCuthillMcKee(long long ncells,
+                    const std::vector<std::array<long long,2> >& face_cells)
+{
+  // cell-to-cell adjacency through interior faces
+  std::vector<std::vector<long long> > nbrs(ncells);
+  for (const auto& fc : face_cells) {
+    if (fc[0] == fc[1]) continue;
+    nbrs[fc[0]].push_back(fc[1]);
+    nbrs[fc[1]].push_back(fc[0]);
+  }
+  auto by_degree = [&nbrs](long long a, long long b) {
+    return nbrs[a].size() < nbrs[b].size() ||
+        (nbrs[a].size() == nbrs[b].size() && a < b);
+  };
+  for (auto& n : nbrs) std::sort(n.begin(), n.end(), by_degree);
+
+  // start each connected component from a cell of minimal degree
+  std::vector<long long> cells(ncells);
+  for (long long c = 0; c != ncells; ++c) cells[c] = c;
+  std::sort(cells.begin(), cells.end(), by_degree);
+
+  std::vector<bool> visited(ncells, false);
+  std::vector<long long> order;
+  order.reserve(ncells);
+  for (long long start : cells) {
+    if (visited[start]) continue;
+
+    // breadth first, visiting neighbors in order of increasing degree
+    std::queue<long long> queue;
+    queue.push(start);
+    visited[start] = true;
+    while (!queue.empty()) {
+      long long c = queue.front();
+      queue.pop();
+      order.push_back(c);
+      for (long long n : nbrs[c]) {
+        if (!visited[n]) {
+          visited[n] = true;
+          queue.push(n);
+        }
+      }
+    }
+  }
+
+  std::reverse(order.begin(), order.end());
+  return order;
+}
+
+
+// spread the low 21 bits of x so that there are two zeros between each
+static uint64_t
+SpreadBits_(uint64_t x)
+{
+  x &= 0x1fffff;
+  x = (x | x << 32) & 0x1f00000000ffffULL;
+  x = (x | x << 16) & 0x1f0000ff0000ffULL;
+  x = (x | x << 8) & 0x100f00f00f00f00fULL;
+  x = (x | x << 4) & 0x10c30c30c30c30c3ULL;
+  x = (x | x << 2) & 0x1249249249249249ULL;
+  return x;
+}
+
+
+std::vector<long long>
+MortonOrder(const std::vector<std::array<double,3> >& centroids)
+{
+  long long ncells = centroids.size();
+
+  // bounding box
+  std::array<double,3> lo, hi;
+  lo.fill(std::numeric_limits<double>::max());
+  hi.fill(std::numeric_limits<double>::lowest());
+  for (const auto& x : centroids) {
+    for (int d = 0; d != 3; ++d) {
+      lo[d] = std::min(lo[d], x[d]);
+      hi[d] = std::max(hi[d], x[d]);
+    }
+  }
+
+  // interleave the bits of the quantized coordinates
+  const double nbins = double((1 << 21) - 1);
+  std::vector<std::pair<uint64_t,long long> > codes(ncells);
+  for (long long c = 0; c != ncells; ++c) {
+    uint64_t code = 0;
+    for (int d = 0; d != 3; ++d) {
+      double width = hi[d] - lo[d];
+      uint64_t q = width > 0. ? uint64_t((centroids[c][d] - lo[d]) / width * nbins) : 0;
+      code |= SpreadBits_(q) << d;
+    }
+    codes[c] = std::make_pair(code, c);
+  }
+  std::sort(codes.begin(), codes.end());
+
+  std::vector<long long> order(ncells);
+  for (long long i = 0; i != ncells; ++i) order[i] = codes[i].second;
+  return order;
+}
+
+} // namespace Arcos
@@ -0,0 +1,41 @@
+//! --------------------------------------------------------------------------------
+//
+// Arcos -- Legion
+//
+// Author: Ethan Coon (coonet@ornl.gov)
+// License: BSD
+//
+// Cell renumberings for locality.
+//
+// The cell order of a mesh read from file is arbitrary.  Renumbering
+// cells so that neighbors have nearby IDs improves cache behavior of
+// every sweep over a tile, and shrinks the ghost regions of a
+// contiguous partition.  Two orderings are provided:
+//
+//   * reverse Cuthill-McKee, from the face adjacency (bandwidth reducing)
+//   * Morton (Z-order) space-filling curve, from the cell centroids
+//
+// Each returns order, where order[new_id] = old_id.
+//
+// ---------------------------------------------------------------------------------
+
+#ifndef ARCOS_RENUMBERING_HH_
+#define ARCOS_RENUMBERING_HH_
+
+#include <array>
+#include <vector>
+
+namespace Arcos {
+
+enum class Renumbering { NONE, RCM, MORTON };
+
+std::vector<long long>
+ReverseCuthillMcKee(long long ncells,
+                    const std::vector<std::array<long long,2> >& face_cells);
+
+std::vector<long long>
+MortonOrder(const std::vector<std::array<double,3> >& centroids);
+
+} // namespace Arcos
+
+#endif
@@ -9,10 +9,16 @@
 //
 // ---------------------------------------------------------------------------------
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include "evaluators.hh"
 #include "evaluator_factory.hh"
 #include "state.hh"
+#include "field_groups.hh"
+#include "imbalance.hh"
+#include "task_managers.hh"
+#include "input_args.hh"
 #include "default_mapper.h"
 
 namespace Arcos {
@@ -21,6 +27,67 @@ void
 State::report() {
   std::cout << "State Report:" << std::endl
 	    << "-------------" << std::endl;
+  SumLaunches_(last_step_recorded_);
+  SumLaunches_(step_recorded_);
+  if (report_stats_.empty()) return;
+  std::map<std::string, KeyStats_> stats;
+  std::swap(stats, report_stats_);
+
+  // the task time of all evaluators, of which each key's share
+  double task_time = 0.;
+  for (const auto& ks : stats) task_time += ks.second.time;
+
+  // bandwidth is per task, i.e. per core
+  printf("  %-12s %8s %12s %12s %12s %12s %10s %7s\n", "key", "launches",
+         "total (s)", "mean (s)", "read (B)", "written (B)", "GB/s/core", "share");
+  for (const auto& ks : stats) {
+    const KeyStats_& t = ks.second;
+    double bytes = t.bytes_read + t.bytes_written;
+    printf("  %-12s %8d %12.4e %12.4e %12.4e %12.4e %10.3f %6.1f%%\n", ks.first.c_str(),
+           t.launches, t.time, t.tasks > 0 ? t.time / t.tasks : 0.,
+           t.bytes_read, t.bytes_written, t.time > 0. ? bytes / t.time / 1.e9 : 0.,
+           task_time > 0. ? 100. * t.time / task_time : 0.);
+  }
+  for (const auto& u : uniform)
+    printf("  %-12s   uniform, = %g\n", u.first.c_str(), u.second);
+
+  // hardware counters, where counted; memory traffic is estimated from
+  // last-level cache misses
+  bool any_counted = false;
+  for (const auto& ks : stats) any_counted |= ks.second.counted > 0;
+  if (!any_counted) return;
+  printf("  %-12s %8s %12s %12s %12s %10s\n", "key", "IPC", "LLC misses",
+         "GFLOP/s/core", "flop/byte", "roofline");
+  for (const auto& ks : stats) {
+    if (ks.second.counted == 0) continue;
+    const KeyStats_& c = ks.second;
+    double ipc = c.cycles > 0. ? c.instructions / c.cycles : 0.;
+    double dram_bytes = c.llc_misses * cache_line_bytes;
+    bool have_fp = c.fp_counted > 0 && c.fp_time > 0.;
+    double gflops = have_fp ? c.fp_ops / c.fp_time / 1.e9 : 0.;
+
+    // as rates, since the FP count may cover fewer tasks than the misses
+    double dram_rate = c.counted_time > 0. ? dram_bytes / c.counted_time : 0.;
+    double intensity = have_fp && dram_rate > 0. ? gflops * 1.e9 / dram_rate : 0.;
+
+    // the roofline at this intensity, per core
+    std::string placement = "n/a";
+    if (have_fp && peak_gflops > 0. && peak_bandwidth > 0. && dram_bytes > 0.) {
+      double attainable = std::min(peak_gflops, intensity * peak_bandwidth);
+      char buf[64];
+      snprintf(buf, sizeof(buf), "%s, %.0f%%",
+               intensity < peak_gflops / peak_bandwidth ? "memory" : "compute",
+               100. * gflops / attainable);
+      placement = buf;
+    }
+    if (have_fp) {
+      printf("  %-12s %8.3f %12.4e %12.4f %12.4f %s\n", ks.first.c_str(), ipc,
+             c.llc_misses, gflops, intensity, placement.c_str());
+    } else {
+      printf("  %-12s %8.3f %12.4e %12s %12s %s\n", ks.first.c_str(), ipc,
+             c.llc_misses, "n/a", "n/a", placement.c_str());
+    }
+  }
 }
 
 void
@@ -28,67 +95,706 @@ State::RequireEvaluator(const std::string& eval_type) {
   std::cout << "Evaluator Required: " << eval_type;
   if (evaluators.count(eval_type) == 0) {
     Evaluator_Factory fac;
-    evaluators[eval_type] = fac.Create(eval_type, *this);
-    field_ids[eval_type] = n_fids;
-    n_fids++;
+    RequireEvaluator(eval_type, fac.Create(eval_type, *this));
   } else {
     std::cout << "  ...already have one." << std::endl;
   }
 }
 
 
+void
+State::RequireEvaluator(const std::string& key, std::unique_ptr<Evaluator> eval) {
+  if (evaluators.count(key)) {
+    std::cout << "State: evaluator for " << key << " already exists" << std::endl;
+    throw("State: evaluator already exists");
+  }
+  for (const auto& dep : eval->Dependencies()) assert(evaluators.count(dep));
+  evaluators[key] = std::move(eval);
+  entities[key] = evaluators[key]->Location();
+  if (entities[key] != Entity::SCALAR) {
+    field_ids[key] = n_fids;
+    n_fids++;
+  }
+  if (setup_) Insert_(key);
+}
+
+
 
 void
 State::Setup() {
-  // create the logical region to hold all data
-  // -- create the index space
-  Legion::IndexSpace untyped_is = runtime->create_index_space(ctx, domain);
-  printf("State Setup:\n  Created untyped index space %x\n", untyped_is.get_id());
+  // create the index space shared by all fields
+  index_space = runtime->create_index_space(ctx, domain);
+  printf("State Setup:\n  Created untyped index space %x\n", index_space.get_id());
 
-  // -- create the field space
-  Legion::FieldSpace fs = runtime->create_field_space(ctx);
-  printf("  Created field space field space %x\n", fs.get_id());
-  {
-    Legion::FieldAllocator allocator = runtime->create_field_allocator(ctx, fs);
-    for (auto fid : field_ids) {
-      allocator.allocate_field(sizeof(double), fid.second);
+  if (mesh) {
+    // renumber for locality before anything is laid out; no field has
+    // data yet, so only the topology and its original IDs are permuted
+    if (renumbering == Renumbering::RCM) {
+      printf("  Renumbering cells by reverse Cuthill-McKee\n");
+      mesh->Renumber(ReverseCuthillMcKee(mesh->ncells, mesh->face_cells));
+    } else if (renumbering == Renumbering::MORTON) {
+      if ((long long) mesh->centroids.size() != mesh->ncells) {
+        std::cout << "State: Morton renumbering requires cell centroids" << std::endl;
+        throw("State: Morton renumbering requires cell centroids");
+      }
+      printf("  Renumbering cells by Morton order of centroids\n");
+      mesh->Renumber(MortonOrder(mesh->centroids));
     }
+    mesh->Setup(ctx, runtime);
   }
 
-  // -- form the cross product to create the LR
-  logical_region = runtime->create_logical_region(ctx, untyped_is, fs);
-  runtime->attach_name(logical_region, "state lr");
-  printf("  Created untyped logical region (%x,%x,%x)\n",
-      logical_region.get_index_space().get_id(), 
-      logical_region.get_field_space().get_id(),
-      logical_region.get_tree_id());
-
   // -- form the partitioning
   // create the partitioning
-  int num_subregions =
+  int num_cores =
       runtime->select_tunable_value(ctx, Legion::Mapping::DefaultMapper::DEFAULT_TUNABLE_GLOBAL_CPUS,
                                   0).get_result<size_t>();
-  printf("Partitioning data into %d sub-regions...\n", num_subregions);
+  int num_subregions = colors > 0 ? colors : num_cores * colors_per_core;
+  printf("Partitioning data into %d sub-regions (%g per core)...\n",
+         num_subregions, (double) num_subregions / num_cores);
+
+  // blocked tiles: the color space has the same dimension as the
+  // domain, so the equal partition blocks each dimension separately
+  tiles = BlockedColors(Extents(domain), num_subregions);
+  printf("  Tiles:");
+  for (auto c : tiles) printf(" %lld", c);
+  printf("\n");
 
-  Legion::Rect<1> color_bounds(0, num_subregions-1);
-  partition = runtime->create_index_space(ctx, color_bounds);
+  partition = runtime->create_index_space(ctx, StructuredDomain(tiles));
   runtime->attach_name(partition, "state partition");
 
-  Legion::IndexPartition ip = runtime->create_equal_partition(ctx, untyped_is, partition);
+  index_partition = runtime->create_equal_partition(ctx, index_space, partition);
+  runtime->attach_name(index_partition, "state partition");
+
+  if (mesh) mesh->Partition(ctx, runtime, index_space, index_partition, partition);
 
-  logical_partition = runtime->get_logical_partition(ctx, logical_region, ip);
-  runtime->attach_name(ip, "state partition");
+  // order the launches, which fixes the live range of each field
+  OrderPlan_();
 
-  // clean up?
-  printf("  Cleaning up FS and IS\n");
-  runtime->destroy_field_space(ctx, fs);
-  runtime->destroy_index_space(ctx, untyped_is);
+  // uniform keys are held as their value, and passed as such; in plan
+  // order, so that uniformity propagates from primaries to the keys
+  // computed from them alone, which are folded on the host.  This comes
+  // before storage is laid out, as uniform keys get no field until they
+  // are materialized.
+  uniform.clear();
+  materialized_.clear();
+  for (const auto& key : plan_keys) FoldUniform_(key);
+
+  std::map<std::string, std::vector<std::string> > reads;
+  std::map<Entity, std::vector<std::string> > keys;
+  for (const auto& eval : evaluators) reads[eval.first] = eval.second->Dependencies();
+  for (const auto& fid : field_ids) keys[entities.at(fid.first)].push_back(fid.first);
+
+  // let intermediates with disjoint live ranges share storage; primaries,
+  // keys nothing reads, persistent keys, and uniform keys keep their own
+  storage.clear();
+  for (const auto& fid : field_ids) storage[fid.first] = fid.first;
+  if (alias_intermediates) {
+    std::set<std::string> keep(persistent);
+    for (const auto& u : uniform) keep.insert(u.first);
+    std::set<std::string> read;
+    for (const auto& eval : reads) {
+      if (eval.second.empty()) keep.insert(eval.first);
+      read.insert(eval.second.begin(), eval.second.end());
+    }
+    for (const auto& fid : field_ids)
+      if (read.count(fid.first) == 0) keep.insert(fid.first);
+
+    for (const auto& entity_keys : keys)
+      for (const auto& alias : AliasByLiveness(plan_keys, reads, entity_keys.second, keep))
+        storage[alias.first] = alias.second;
+  }
+
+  // group the storage by co-access, separately for each entity
+  std::map<std::string, std::vector<std::string> > storage_reads;
+  for (const auto& eval : reads)
+    for (const auto& dep : eval.second)
+      if (storage.count(dep)) storage_reads[eval.first].push_back(storage.at(dep));
+  std::vector<std::pair<Entity, std::vector<std::string> > > groups;
+  for (const auto& entity_keys : keys) {
+    std::vector<std::string> stored;
+    for (const auto& key : entity_keys.second)
+      if (storage.at(key) == key) stored.push_back(key);
+    for (auto& group_keys : GroupByCoAccess(storage_reads, stored, max_group_size))
+      groups.emplace_back(entity_keys.first, std::move(group_keys));
+  }
+
+  // create a field space and logical region for each group
+  for (auto& entity_group_keys : groups) {
+    std::vector<std::string> group_keys;
+    for (const auto& st : storage) {
+      if (std::find(entity_group_keys.second.begin(), entity_group_keys.second.end(), st.second)
+          != entity_group_keys.second.end()) group_keys.push_back(st.first);
+    }
+    AddGroup_(entity_group_keys.first, std::move(group_keys));
+  }
+
+  Prioritize_();
+  for (const auto& key : plan_keys) plan.push_back(evaluators.at(key)->LaunchEntry(*this));
+
+  if (hierarchical) {
+    for (const auto& group : field_groups) {
+      if (group.entity != Entity::CELL) {
+        std::cout << "State: hierarchical launches support only cell fields" << std::endl;
+        throw("State: hierarchical launches support only cell fields");
+      }
+    }
+    // inner tasks cannot be handed the futures of scalars
+    for (const auto& ent : entities) {
+      if (ent.second == Entity::SCALAR) {
+        std::cout << "State: hierarchical launches do not support scalar " << ent.first << std::endl;
+        throw("State: hierarchical launches do not support scalars");
+      }
+    }
+
+    // coarse tiles per node (by default), each with a fine tile per local core
+    int num_coarse = coarse_colors > 0 ? coarse_colors :
+        runtime->select_tunable_value(ctx, Legion::Mapping::DefaultMapper::DEFAULT_TUNABLE_NODE_COUNT,
+                                      0).get_result<size_t>();
+    int num_local =
+        runtime->select_tunable_value(ctx, Legion::Mapping::DefaultMapper::DEFAULT_TUNABLE_LOCAL_CPUS,
+                                      0).get_result<size_t>();
+    fine_colors_ = num_local * colors_per_core;
+    auto coarse_tiles = BlockedColors(Extents(domain), num_coarse);
+    printf("  Hierarchical: %d coarse tiles of %d fine tiles each\n", num_coarse, fine_colors_);
+
+    coarse_partition = runtime->create_index_space(ctx, StructuredDomain(coarse_tiles));
+    runtime->attach_name(coarse_partition, "state coarse partition");
+    coarse_index_partition = runtime->create_equal_partition(ctx, index_space, coarse_partition);
+    runtime->attach_name(coarse_index_partition, "state coarse partition");
+  }
+  setup_ = true;
   printf("  Setup Completed!\n");
 };
 
+
+std::vector<Legion::LogicalPartition>
+State::GroupPartitions() const {
+  std::vector<Legion::LogicalPartition> partitions;
+  for (const auto& group : field_groups) partitions.push_back(group.logical_partition);
+  return partitions;
+}
+
+
+std::vector<Legion::LogicalRegion>
+State::GroupRegions() const {
+  std::vector<Legion::LogicalRegion> regions;
+  for (const auto& group : field_groups) regions.push_back(group.logical_region);
+  return regions;
+}
+
+
+void
+State::OrderPlan_() {
+  plan.clear();
+  plan_keys.clear();
+  std::set<std::string> done;
+  for (const auto& eval : evaluators) OrderPlan_(eval.first, done);
+}
+
+
+// depth-first, so that every key follows its dependencies
+void
+State::OrderPlan_(const std::string& key, std::set<std::string>& done) {
+  if (done.count(key)) return;
+  done.insert(key);
+  for (const auto& dep : evaluators.at(key)->Dependencies()) OrderPlan_(dep, done);
+  plan_keys.push_back(key);
+}
+
+
+std::vector<int>
+State::PlanIndices_(const std::string& key) const {
+  // the keys needed, walking the plan backwards from key
+  std::set<std::string> needed = {key};
+  for (int i = plan_keys.size() - 1; i >= 0; --i) {
+    if (needed.count(plan_keys[i]))
+      for (const auto& dep : evaluators.at(plan_keys[i])->Dependencies()) needed.insert(dep);
+  }
+
+  std::vector<int> indices;
+  for (int i = 0; i != (int) plan_keys.size(); ++i)
+    if (needed.count(plan_keys[i])) indices.push_back(i);
+  return indices;
+}
+
+
+std::vector<PlanEntry>
+State::Plan(const std::string& key) const {
+  std::vector<PlanEntry> entries;
+  for (int i : PlanIndices_(key)) entries.push_back(plan[i]);
+  return entries;
+}
+
+
+void
+State::Update(const std::string& key) {
+  if (!hierarchical) {
+    if (alias_intermediates) {
+      // aliased storage may have been overwritten since it was last
+      // computed, so the whole sub-DAG is launched, in plan order
+      for (int i : PlanIndices_(key)) evaluators.at(plan_keys[i])->Launch(*this);
+    } else {
+      evaluators.at(key)->Update(*this, "main");
+    }
+    return;
+  }
+
+  // The whole sub-DAG is replayed by each inner task, so dependence
+  // analysis of the leaf launches happens on the coarse color's
+  // processor rather than here.
+  if (Verbose()) std::cout << "Launching Inner tasks for " << key << std::endl;
+  auto entries = Plan(key);
+  InnerHeader header;
+  header.nfine = fine_colors_;
+  header.nentries = entries.size();
+  std::vector<char> args(sizeof(InnerHeader) + entries.size()*sizeof(PlanEntry));
+  std::memcpy(args.data(), &header, sizeof(InnerHeader));
+  std::memcpy(args.data() + sizeof(InnerHeader), entries.data(), entries.size()*sizeof(PlanEntry));
+
+  Legion::IndexLauncher launcher(TaskManagerInner::taskid, coarse_partition,
+          Legion::TaskArgument(args.data(), args.size()), Legion::ArgumentMap());
+  for (const auto& group : field_groups) {
+    auto lp = runtime->get_logical_partition(ctx, group.logical_region, coarse_index_partition);
+    Legion::RegionRequirement rr(lp, 0, READ_WRITE, EXCLUSIVE, group.logical_region);
+    std::set<Legion::FieldID> fids;
+    for (const auto& gkey : group.keys)
+      if (!uniform.count(gkey) || materialized_.count(gkey)) fids.insert(field_ids.at(gkey));
+    for (auto fid : fids) rr.add_field(fid);
+    launcher.add_region_requirement(rr);
+  }
+  futures[key] = runtime->execute_index_space(ctx, launcher);
+}
+
+void
+State::AddGroup_(Entity entity, std::vector<std::string> keys) {
+  FieldGroup group;
+  group.entity = entity;
+  group.keys = std::move(keys);
+  if (group.entity == Entity::FACE && !mesh) {
+    std::cout << "State: face fields require a mesh" << std::endl;
+    throw("State: face fields require a mesh");
+  }
+  Legion::IndexSpace is = group.entity == Entity::CELL ? index_space : mesh->faces;
+  Legion::IndexPartition ip = group.entity == Entity::CELL ? index_partition : mesh->face_partition;
+
+  // -- create the field space
+  group.field_space = runtime->create_field_space(ctx);
+  printf("  Created field space %x with fields:", group.field_space.get_id());
+  {
+    Legion::FieldAllocator allocator = runtime->create_field_allocator(ctx, group.field_space);
+    for (const auto& key : group.keys) {
+      const auto& st = storage.at(key);
+      if (st == key && uniform.count(key)) {
+        // allocated only if materialized
+        printf(" %s(uniform)", key.c_str());
+      } else if (st == key) {
+        allocator.allocate_field(sizeof(double), field_ids.at(key));
+        printf(" %s", key.c_str());
+      } else {
+        field_ids[key] = field_ids.at(st);
+        printf(" %s(=%s)", key.c_str(), st.c_str());
+      }
+      group_ids[key] = field_groups.size();
+    }
+  }
+  printf("\n");
+
+  // -- form the cross product to create the LR
+  group.logical_region = runtime->create_logical_region(ctx, is, group.field_space);
+  runtime->attach_name(group.logical_region, "state lr");
+  printf("  Created untyped logical region (%x,%x,%x)\n",
+         group.logical_region.get_index_space().get_id(), 
+         group.logical_region.get_field_space().get_id(),
+         group.logical_region.get_tree_id());
+
+  group.logical_partition =
+      runtime->get_logical_partition(ctx, group.logical_region, ip);
+  field_groups.emplace_back(std::move(group));
+}
+
+
+void
+State::Insert_(const std::string& key) {
+  // a new reader extends the live range of what it reads, which would
+  // clobber any key sharing that storage
+  const auto& deps = evaluators.at(key)->Dependencies();
+  for (const auto& dep : deps) {
+    for (const auto& st : storage) {
+      if (st.first != st.second && (st.first == dep || st.second == dep)) {
+        std::cout << "State: " << key << " cannot read aliased key " << dep
+                  << " after Setup(); mark it persistent" << std::endl;
+        throw("State: cannot read aliased key after Setup()");
+      }
+    }
+  }
+  // a scalar has no field to place
+  if (entities.at(key) == Entity::SCALAR) {
+    if (hierarchical) {
+      std::cout << "State: hierarchical launches do not support scalar " << key << std::endl;
+      throw("State: hierarchical launches do not support scalars");
+    }
+    FoldUniform_(key);
+    plan_keys.push_back(key);
+    Prioritize_();
+    plan.push_back(evaluators.at(key)->LaunchEntry(*this));
+    return;
+  }
+  storage[key] = key;
+  persistent.insert(key);
+  FoldUniform_(key);
+
+  // Nothing reads the new key yet, so there is no co-access to go on;
+  // place it with most of its dependencies, where later readers of the
+  // chain likely look, if that group has room.
+  std::map<int,int> affinity;
+  for (const auto& dep : deps) {
+    if (!group_ids.count(dep)) continue;
+    int g = group_ids.at(dep);
+    if (field_groups[g].entity == entities.at(key)) affinity[g]++;
+  }
+  int best = -1, best_affinity = 0;
+  for (const auto& ga : affinity) {
+    int nstored = 0;
+    for (const auto& gkey : field_groups[ga.first].keys)
+      if (storage.at(gkey) == gkey) nstored++;
+    if (max_group_size > 0 && nstored >= max_group_size) continue;
+    if (ga.second > best_affinity) {
+      best = ga.first;
+      best_affinity = ga.second;
+    }
+  }
+
+  if (best < 0) {
+    AddGroup_(entities.at(key), {key});
+  } else {
+    // regions and partitions of the field space pick up the new field,
+    // and existing fields and instances are untouched
+    FieldGroup& group = field_groups[best];
+    if (!uniform.count(key)) {
+      Legion::FieldAllocator allocator = runtime->create_field_allocator(ctx, group.field_space);
+      allocator.allocate_field(sizeof(double), field_ids.at(key));
+    }
+    group.keys.push_back(key);
+    group_ids[key] = best;
+    printf("  Added field %s to field space %x\n", key.c_str(), group.field_space.get_id());
+  }
+
+  // dependencies were inserted first, so appending keeps the plan ordered
+  plan_keys.push_back(key);
+  Prioritize_();
+  plan.push_back(evaluators.at(key)->LaunchEntry(*this));
+}
+
+
+int
+State::Priority(const std::string& key) const {
+  auto p = priorities.find(key);
+  return p == priorities.end() ? 0 : p->second;
+}
+
+
+void
+State::Prioritize_() {
+  // the longest path from each key to the end of the plan, including
+  // its own cost, in reverse plan order so that consumers come first
+  std::map<std::string,double>& path = path_lengths_;
+  path.clear();
+  std::map<std::string,double> tail;  // longest path of any consumer
+  double longest = 0.;
+  for (int i = plan_keys.size() - 1; i >= 0; --i) {
+    const auto& key = plan_keys[i];
+    double cost = 0.;
+    if (!uniform.count(key)) cost = costs.count(key) ? costs.at(key) : 1.;
+    path[key] = cost + tail[key];
+    longest = std::max(longest, path[key]);
+    for (const auto& dep : evaluators.at(key)->Dependencies())
+      tail[dep] = std::max(tail[dep], path[key]);
+  }
+
+  priorities.clear();
+  for (const auto& p : path)
+    priorities[p.first] = longest > 0. ? (int) (ARCOS_MAX_PRIORITY * p.second / longest) : 0;
+  for (size_t i = 0; i != plan.size(); ++i) plan[i].priority = Priority(plan_keys[i]);
+}
+
+
+std::vector<std::string>
+State::CriticalPath() const {
+  std::vector<std::string> critical;
+  if (path_lengths_.empty()) return critical;
+
+  // from the key starting the longest path, follow the consumer whose
+  // remaining path is longest
+  auto longest = [this](const std::string& a, const std::string& b) {
+    return path_lengths_.at(a) < path_lengths_.at(b);
+  };
+  std::string key = plan_keys[0];
+  for (const auto& k : plan_keys) if (longest(key, k)) key = k;
+  while (true) {
+    critical.push_back(key);
+    std::string next;
+    for (const auto& eval : evaluators) {
+      auto deps = eval.second->Dependencies();
+      if (std::find(deps.begin(), deps.end(), key) == deps.end()) continue;
+      if (next.empty() || longest(next, eval.first)) next = eval.first;
+    }
+    if (next.empty()) break;
+    key = next;
+  }
+  return critical;
+}
+
+
+void
+State::FoldUniform_(const std::string& key) {
+  const auto& eval = evaluators.at(key);
+  bool primary = eval->Dependencies().empty();
+  if (primary ? !uniform_primaries : !fold_uniform) return;
+
+  double value;
+  if (eval->Uniform(*this, value)) {
+    uniform[key] = value;
+    if (!primary) std::cout << "  Folded uniform " << key << " = " << value << std::endl;
+  }
+}
+
+
+void
+State::Materialize(const std::string& key) {
+  // a scalar has no field to fill
+  if (!uniform.count(key) || materialized_.count(key) || entities.at(key) == Entity::SCALAR) return;
+  if (storage.at(key) != key) {
+    std::cout << "State: cannot materialize aliased key " << key << "; mark it persistent" << std::endl;
+    throw("State: cannot materialize aliased key");
+  }
+  std::cout << "State: materializing uniform " << key << " = " << uniform.at(key) << std::endl;
+  const FieldGroup& group = Group(key);
+
+  // the field is allocated only now, so that instances do not carry
+  // storage for uniform keys that are never read as fields
+  {
+    Legion::FieldAllocator allocator = runtime->create_field_allocator(ctx, group.field_space);
+    allocator.allocate_field(sizeof(double), field_ids.at(key));
+  }
+  runtime->fill_field<double>(ctx, group.logical_region, group.logical_region,
+          field_ids.at(key), uniform.at(key));
+  materialized_.insert(key);
+}
+
+
+void
+State::AddScalars(const std::vector<std::string>& deps, Legion::IndexLauncher& launcher) const {
+  for (const auto& dep : deps)
+    if (entities.at(dep) == Entity::SCALAR && !uniform.count(dep)) launcher.add_future(scalars.at(dep));
+}
+
+
+void
+State::RecordLaunch(const std::string& key, const Legion::FutureMap& launch) {
+  futures[key] = launch;
+  step_recorded_.emplace_back(key, launch);
+  if (imbalance_report) step_launches_.emplace_back(key, launch);
+  if (rebalance_window > 0) window_launches_.push_back(launch);
+}
+
+
+void
+State::SumLaunches_(std::vector<std::pair<std::string, Legion::FutureMap> >& launches) {
+  // this waits on the launches
+  auto color_domain = runtime->get_index_space_domain(ctx, partition);
+  for (const auto& kl : launches) {
+    auto inserted = report_stats_.emplace(kl.first,
+            KeyStats_{0, 0, 0., 0., 0., 0, 0., 0., 0., 0., 0, 0., 0.});
+    KeyStats_& ks = inserted.first->second;
+    double launch_time = 0.;
+    int n = 0;
+    for (Legion::Domain::DomainPointIterator c(color_domain); c; c++, n++) {
+      TaskStats ts = kl.second.get_result<TaskStats>(*c);
+      launch_time += ts.time;
+      ks.time += ts.time;
+      ks.bytes_read += ts.bytes_read;
+      ks.bytes_written += ts.bytes_written;
+      ks.tasks++;
+      if (ts.counters.cycles >= 0. && ts.counters.instructions >= 0.) {
+        ks.cycles += ts.counters.cycles;
+        ks.instructions += ts.counters.instructions;
+        ks.llc_misses += std::max(ts.counters.llc_misses, 0.);
+        ks.counted++;
+        ks.counted_time += ts.time;
+
+        // the FP event is not available on every CPU
+        if (ts.counters.fp_ops >= 0.) {
+          ks.fp_ops += ts.counters.fp_ops;
+          ks.fp_counted++;
+          ks.fp_time += ts.time;
+        }
+      }
+    }
+    ks.launches++;
+
+    // the mean time per color of each key's latest launch is its cost
+    // on the critical path
+    costs[kl.first] = n > 0 ? launch_time / n : 0.;
+  }
+  launches.clear();
+}
+
+
+void
+State::EndStep() {
+  // the last step has had this one to finish in; its measured costs
+  // reprioritize the launches to come
+  if (!last_step_recorded_.empty()) {
+    SumLaunches_(last_step_recorded_);
+    Prioritize_();
+  }
+  std::swap(last_step_recorded_, step_recorded_);
+
+  if (imbalance_report) ReportImbalance_();
+  if (rebalance_window <= 0) return;
+  window_steps_++;
+  if (window_steps_ < rebalance_window) return;
+
+  // sum the time of each color over the window; this waits on the
+  // window's tasks
+  auto color_domain = runtime->get_index_space_domain(ctx, partition);
+  std::map<Legion::DomainPoint, double> color_times;
+  for (Legion::Domain::DomainPointIterator c(color_domain); c; c++) {
+    double time = 0.;
+    for (const auto& launch : window_launches_) time += launch.get_result<TaskStats>(*c).time;
+    color_times[*c] = time;
+  }
+  window_launches_.clear();
+  window_steps_ = 0;
+
+  double imbalance = MeasureImbalance(color_times, 1).ratio;
+  printf("State: load imbalance (max/mean) over %d steps = %g\n", rebalance_window, imbalance);
+  if (imbalance <= rebalance_threshold) return;
+
+  // spread each color's time over its current tile and recut
+  std::map<Legion::DomainPoint, Legion::Domain> current;
+  for (Legion::Domain::DomainPointIterator c(color_domain); c; c++)
+    current[*c] = runtime->get_index_space_domain(ctx,
+            runtime->get_index_subspace(ctx, index_partition, *c));
+  printf("State: rebalancing\n");
+  Repartition_(WeightedTiles(domain, tiles, TileMarginals(domain, current, color_times)));
+}
+
+
+void
+State::ReportImbalance_() {
+  // this waits on the step's tasks
+  auto color_domain = runtime->get_index_space_domain(ctx, partition);
+  std::map<Legion::DomainPoint, double> step_times;
+  printf("State: per-color task times this step\n");
+  for (const auto& kl : step_launches_) {
+    std::map<Legion::DomainPoint, double> times;
+    for (Legion::Domain::DomainPointIterator c(color_domain); c; c++) {
+      double time = kl.second.get_result<TaskStats>(*c).time;
+      times[*c] = time;
+      step_times[*c] += time;
+    }
+    PrintImbalance(kl.first, MeasureImbalance(times, histogram_bins));
+  }
+  step_launches_.clear();
+  if (step_times.empty()) return;
+  PrintImbalance("all evaluators", MeasureImbalance(step_times, histogram_bins));
+
+  // a straggler persists while it is slow in consecutive steps
+  std::map<Legion::DomainPoint, int> counts;
+  for (const auto& c : Stragglers(step_times, straggler_threshold)) {
+    auto prev = straggler_counts.find(c);
+    counts[c] = prev == straggler_counts.end() ? 1 : prev->second + 1;
+  }
+  straggler_counts = std::move(counts);
+  for (const auto& sc : straggler_counts) {
+    if (sc.second >= straggler_steps)
+      printf("  persistent straggler: color %s, over %g x mean for %d steps\n",
+             ColorString(sc.first).c_str(), straggler_threshold, sc.second);
+  }
+}
+
+
+// sums of a cell field over each slab of cells, for each dimension
+template<int DIM>
+static void
+Marginals_(const Legion::PhysicalRegion& pr, Legion::FieldID fid,
+           const Legion::Domain& domain, std::vector<std::vector<double> >& marginals)
+{
+  auto extents = Extents(domain);
+  marginals.resize(DIM);
+  for (int d = 0; d != DIM; ++d) marginals[d].assign(extents[d], 0.);
+
+  const Legion::FieldAccessor<READ_ONLY,double,DIM> acc(pr, fid);
+  for (Legion::PointInRectIterator<DIM> p(domain); p(); ++p) {
+    double cost = acc[*p];
+    for (int d = 0; d != DIM; ++d) marginals[d][(*p)[d] - domain.lo()[d]] += cost;
+  }
+}
+
+
+void
+State::Repartition(const std::string& cost_key) {
+  std::cout << "State: repartitioning by cost field " << cost_key << std::endl;
+  const FieldGroup& group = Group(cost_key);
+  assert(group.entity == Entity::CELL);
+  Materialize(cost_key);
+
+  // this waits on the cost field, which is fine as long as repartitioning
+  // is rare
+  Legion::RegionRequirement req(group.logical_region, READ_ONLY, EXCLUSIVE, group.logical_region);
+  req.add_field(field_ids.at(cost_key));
+  Legion::PhysicalRegion pr = runtime->map_region(ctx, Legion::InlineLauncher(req));
+  pr.wait_until_valid();
+
+  std::vector<std::vector<double> > marginals;
+  switch (domain.get_dim()) {
+    case 1: Marginals_<1>(pr, field_ids.at(cost_key), domain, marginals); break;
+#if ARCOS_MAX_DIM >= 2
+    case 2: Marginals_<2>(pr, field_ids.at(cost_key), domain, marginals); break;
+#endif
+#if ARCOS_MAX_DIM >= 3
+    case 3: Marginals_<3>(pr, field_ids.at(cost_key), domain, marginals); break;
+#endif
+    default: assert(false);
+  }
+  runtime->unmap_region(ctx, pr);
+
+  Repartition_(WeightedTiles(domain, tiles, marginals));
+}
+
+
+void
+State::Repartition_(const std::map<Legion::DomainPoint, Legion::Domain>& new_tiles) {
+  Legion::IndexPartition old = index_partition;
+  index_partition = runtime->create_partition_by_domain(ctx, index_space, new_tiles,
+          partition, true, DISJOINT_COMPLETE_KIND);
+  runtime->attach_name(index_partition, "state partition");
+
+  if (mesh) mesh->Partition(ctx, runtime, index_space, index_partition, partition);
+  for (auto& group : field_groups) {
+    Legion::IndexPartition ip = group.entity == Entity::CELL ? index_partition : mesh->face_partition;
+    group.logical_partition = runtime->get_logical_partition(ctx, group.logical_region, ip);
+  }
+  runtime->destroy_index_partition(ctx, old);
+
+  // the colors have new tiles, so their history no longer applies
+  straggler_counts.clear();
+}
+
+
 State::~State() {
-  runtime->destroy_logical_region(ctx, logical_region);
+  for (auto& group : field_groups) {
+    runtime->destroy_logical_region(ctx, group.logical_region);
+    runtime->destroy_field_space(ctx, group.field_space);
+  }
+  if (mesh) mesh->Destroy(ctx, runtime);
+  if (coarse_partition.exists()) {
+    runtime->destroy_index_partition(ctx, coarse_index_partition);
+    runtime->destroy_index_space(ctx, coarse_partition);
+  }
   runtime->destroy_index_space(ctx, partition);
+  runtime->destroy_index_space(ctx, index_space);
 }
 
 
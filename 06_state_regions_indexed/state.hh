@@ -13,18 +13,56 @@
 #ifndef STATE_HH_
 #define STATE_HH_
 
+#include <set>
 #include "legion.h"
+#include "partitioning.hh"
+#include "mesh.hh"
+#include "renumbering.hh"
+#include "launch_plan.hh"
 
 namespace Arcos {
 
 class Evaluator;
 
+//
+// A set of fields which are read together, and therefore live in the
+// same field space and logical region.
+//
+struct FieldGroup {
+  Entity entity;
+  Legion::FieldSpace field_space;
+  Legion::LogicalRegion logical_region;
+  Legion::LogicalPartition logical_partition;
+  std::vector<std::string> keys;
+};
+
 struct State {
-  State(Legion::Context ctx_, Legion::Runtime *runtime_, int ncells)
+  // a 1D domain of ncells cells
+  State(Legion::Context ctx_, Legion::Runtime *runtime_, int ncells,
+        int max_group_size_=8)
     : ctx(ctx_),
       runtime(runtime_),
       domain(Legion::DomainPoint(0), Legion::DomainPoint(ncells-1)),
-      n_fids(0)
+      max_group_size(max_group_size_)
+  {}
+
+  // a structured 1D, 2D, or 3D domain of extents[0] x extents[1] x ... cells
+  State(Legion::Context ctx_, Legion::Runtime *runtime_,
+        const std::vector<long long>& extents, int max_group_size_=8)
+    : ctx(ctx_),
+      runtime(runtime_),
+      domain(StructuredDomain(extents)),
+      max_group_size(max_group_size_)
+  {}
+
+  // the cells of an unstructured mesh, which also provides faces
+  State(Legion::Context ctx_, Legion::Runtime *runtime_, Mesh mesh_,
+        int max_group_size_=8)
+    : ctx(ctx_),
+      runtime(runtime_),
+      domain(Legion::DomainPoint(0), Legion::DomainPoint(mesh_.ncells-1)),
+      mesh(new Mesh(std::move(mesh_))),
+      max_group_size(max_group_size_)
   {}
 
   ~State();
@@ -32,21 +70,237 @@ struct State {
   Legion::Context ctx;
   Legion::Runtime *runtime;
   Legion::Domain domain;
-  Legion::LogicalRegion logical_region;
-  Legion::LogicalPartition logical_partition;
-  Legion::IndexSpace partition;
+  Legion::IndexSpace index_space;
+  Legion::IndexPartition index_partition;
+  Legion::IndexSpace partition; // the color space, blocked tiles of domain
+
+  // overdecomposition: the number of colors is colors_per_core times the
+  // number of cores (or colors, if > 0), laid out as tiles[0] x tiles[1] x ...
+  int colors_per_core = 1;
+  int colors = 0;
+  std::vector<long long> tiles;
+
+  // dynamic load balancing: every rebalance_window steps (0 disables),
+  // the measured time of each color is summed over the window, and if
+  // the imbalance (max / mean) exceeds rebalance_threshold, the tiles are
+  // recut to even out the measured cost
+  int rebalance_window = 0;
+  double rebalance_threshold = 1.25;
+
+  // imbalance instrumentation: if imbalance_report, EndStep() prints, for
+  // each launch of the step and for the step as a whole, the per-color
+  // task time statistics and a histogram, waiting on the step's tasks.
+  // Colors slower than straggler_threshold times the mean are counted in
+  // straggler_counts while they stay slow, and reported as persistent
+  // after straggler_steps consecutive steps.
+  bool imbalance_report = false;
+  int histogram_bins = 10;
+  double straggler_threshold = 1.5;
+  int straggler_steps = 3;
+  std::map<Legion::DomainPoint, int> straggler_counts;
+
+  // roofline of one core, for placing evaluators in report() when run
+  // with hardware counters (-arcos:perf): peak GFLOP/s and memory
+  // bandwidth in GB/s (0 if unknown), and the bytes per cache miss
+  double peak_gflops = 0.;
+  double peak_bandwidth = 0.;
+  int cache_line_bytes = 64;
+
+  // optional unstructured mesh topology, whose cells are the domain
+  std::unique_ptr<Mesh> mesh;
+
+  // optional renumbering of the mesh's cells at Setup(); the original
+  // IDs are kept in mesh->cell_ids
+  Renumbering renumbering = Renumbering::NONE;
+
+  // two-level partitioning: if hierarchical, Update() launches one inner
+  // task per coarse color (coarse_colors, or one per node if 0), each of
+  // which replays the plan over a fine partition of its tile with one
+  // color per local core (times colors_per_core).  Cell fields only.
+  bool hierarchical = false;
+  int coarse_colors = 0;
+  Legion::IndexSpace coarse_partition; // the coarse color space
+  Legion::IndexPartition coarse_index_partition;
+
+  // fields are grouped into field spaces by co-access, at most
+  // max_group_size fields per group (<= 0 for no limit)
+  int max_group_size;
+  std::vector<FieldGroup> field_groups;
+  std::map<std::string,int> group_ids;
+
+  // if alias_intermediates, keys whose live ranges (over the plan) do not
+  // overlap share a field; storage maps each key to the key whose field
+  // it uses.  Primaries, keys nothing reads, and persistent keys are
+  // never aliased.  Update() then recomputes the whole sub-DAG.
+  bool alias_intermediates = false;
+  std::set<std::string> persistent;
+  std::map<std::string,std::string> storage;
+
+  // if uniform_primaries, keys that are the same everywhere (primaries)
+  // are held as their value in uniform, passed to consumers by value,
+  // and never launched.  They have no field until Materialize()
+  // allocates and fills it for those who need it dense.  If
+  // fold_uniform, so are keys computed only from uniform keys, evaluated
+  // once on the host.
+  bool uniform_primaries = false;
+  bool fold_uniform = false;
+  std::map<std::string,double> uniform;
   
   std::map<std::string,Legion::FutureMap> futures;
+
+  // scalar keys (reductions of fields) are held as the future of their
+  // last launch, and have no field; consumers are passed the future, so
+  // that neither the reduction nor its use waits here.  Get the value
+  // with scalars.at(key).get_result<double>(), which does wait.
+  std::map<std::string,Legion::Future> scalars;
+
   std::map<std::string,Legion::FieldID> field_ids;
+  std::map<std::string,Entity> entities;
   std::map<std::string,std::unique_ptr<Evaluator> > evaluators;
 
+  // critical path priorities: each launch is tagged with the (scaled)
+  // length of the longest path from it to the end of the plan, using the
+  // cost of each key's launch, 1 until measured from the launches that
+  // EndStep() sums each step; the mapper runs higher priorities first
+  std::map<std::string,double> costs;
+  std::map<std::string,int> priorities;
+  int Priority(const std::string& key) const;
+
+  // the keys along the longest path through the plan, in order
+  std::vector<std::string> CriticalPath() const;
+
+  // Writes the evaluator DAG, with each key's launch cost, storage,
+  // field group, and aliasing, and the critical path highlighted, as
+  // Graphviz DOT or as JSON.  Best after a run, once costs are measured.
+  void WriteDot(const std::string& filename) const;
+  void WriteJson(const std::string& filename) const;
+
+  // every evaluator's launch, in dependency order, and its key
+  std::vector<PlanEntry> plan;
+  std::vector<std::string> plan_keys;
+
+  // the group holding a key's field
+  const FieldGroup& Group(const std::string& key) const {
+    return field_groups[group_ids.at(key)];
+  }
+
+  // the logical partition and region of each field group, by group id
+  std::vector<Legion::LogicalPartition> GroupPartitions() const;
+  std::vector<Legion::LogicalRegion> GroupRegions() const;
+
+  // the plan entries needed to compute key, in dependency order
+  std::vector<PlanEntry> Plan(const std::string& key) const;
+
+  // Prints, for each evaluator launched since the last report, its
+  // number of launches, total and mean task time, bytes read and
+  // written, achieved bandwidth, and share of the task time of all
+  // evaluators.  This waits on the launches not yet summed.
   void report();
+
+  // Requires an evaluator, and those of its dependencies.  After Setup(),
+  // its field is allocated in place and its launch appended to the plan;
+  // existing data, partitions, and instances are kept.
   void RequireEvaluator(const std::string& eval_type);
 
+  // Requires an evaluator built elsewhere (e.g. a generated DAG) rather
+  // than by the factory.  Its dependencies must already be required.
+  void RequireEvaluator(const std::string& key, std::unique_ptr<Evaluator> eval);
+
   void Setup();
 
+  // Allocates and fills the field of a uniform key, if not yet done.
+  // Needed before reading the field of a uniform key outside of the plan.
+  void Materialize(const std::string& key);
+
+  // Brings key up to date, either through its evaluator or, if
+  // hierarchical, by inner tasks on the coarse colors.
+  void Update(const std::string& key);
+
+  // Adds the futures of the (non-uniform) scalar keys among deps to a
+  // launcher, in order, as the scalar arguments of a plan entry expect.
+  void AddScalars(const std::vector<std::string>& deps, Legion::IndexLauncher& launcher) const;
+
+  // Every index launch of an evaluator is recorded here.  Its future map
+  // holds the TaskStats of each color.
+  void RecordLaunch(const std::string& key, const Legion::FutureMap& launch);
+
+  // Marks the end of a timestep, rebalancing if it is time to.
+  void EndStep();
+
+  // Moves tile boundaries so that every color has roughly the same total
+  // cost, as given by the (cell) field cost_key.  Evaluators launched
+  // afterwards use the new partition; the runtime moves the data.
+  void Repartition(const std::string& cost_key);
+
  private:
-  int n_fids;
+  // creates the field space, region, and partition of a new field group
+  void AddGroup_(Entity entity, std::vector<std::string> keys);
+
+  // adds a required evaluator's field and launch after Setup()
+  void Insert_(const std::string& key);
+  bool setup_ = false;
+
+  // recomputes priorities, and those of the plan
+  void Prioritize_();
+  std::map<std::string,double> path_lengths_;
+
+  // bytes of storage of a key, 0 if it has none of its own
+  double Bytes_(const std::string& key) const;
+
+  // adds key to uniform if it is
+  void FoldUniform_(const std::string& key);
+
+  // uniform keys whose fields have been filled
+  std::set<std::string> materialized_;
+
+  // orders the evaluator DAG into plan_keys
+  void OrderPlan_();
+  void OrderPlan_(const std::string& key, std::set<std::string>& done);
+
+  // the indices of the plan needed to compute key
+  std::vector<int> PlanIndices_(const std::string& key) const;
+
+  // replaces the partition with one of the given tiles, and re-derives
+  // everything that depends upon it
+  void Repartition_(const std::map<Legion::DomainPoint, Legion::Domain>& tiles);
+
+  // prints the step's imbalance and tracks stragglers
+  void ReportImbalance_();
+  std::vector<std::pair<std::string, Legion::FutureMap> > step_launches_;
+
+  // per-key sums of the launches since the last report
+  struct KeyStats_ {
+    int launches;
+    long long tasks;
+    double time;
+    double bytes_read;
+    double bytes_written;
+    long long counted;    // tasks with valid hardware counters
+    double counted_time;
+    double cycles;
+    double instructions;
+    double llc_misses;
+    long long fp_counted; // of which, those with a valid FP count
+    double fp_time;
+    double fp_ops;
+  };
+  std::map<std::string, KeyStats_> report_stats_;
+
+  // launches not yet summed into report_stats_: those of this step, and
+  // those of the last, which EndStep() sums (waiting on them) only once
+  // the next step has been issued, so that only two steps are retained
+  std::vector<std::pair<std::string, Legion::FutureMap> > step_recorded_;
+  std::vector<std::pair<std::string, Legion::FutureMap> > last_step_recorded_;
+  void SumLaunches_(std::vector<std::pair<std::string, Legion::FutureMap> >& launches);
+
+  // launches since the start of the rebalancing window
+  std::vector<Legion::FutureMap> window_launches_;
+  int window_steps_ = 0;
+
+  // fine colors per coarse color
+  int fine_colors_ = 0;
+
+  int n_fids = 0;
 };
 
 } // namespace Arcos
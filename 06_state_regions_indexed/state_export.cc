@@ -0,0 +1,144 @@
+//! --------------------------------------------------------------------------------
+//
+// Arcos -- Legion
+//
+// Author: Ethan Coon (coonet@ornl.gov)
+// License: BSD
+//
+// Export of State's evaluator DAG for visualization.
+//
+// ---------------------------------------------------------------------------------
+
+#include <fstream>
+#include <iostream>
+#include <set>
+#include "evaluators.hh"
+#include "state.hh"
+
+namespace Arcos {
+
+double
+State::Bytes_(const std::string& key) const {
+  if (uniform.count(key) || !storage.count(key) || storage.at(key) != key) return 0.;
+  double n = entities.at(key) == Entity::CELL ? domain.get_volume() : mesh->face_cells.size();
+  return n * sizeof(double);
+}
+
+
+static double
+Cost_(const State& S, const std::string& key)
+{
+  if (S.uniform.count(key)) return 0.;
+  return S.costs.count(key) ? S.costs.at(key) : 1.;
+}
+
+
+static const char*
+EntityName_(Entity entity)
+{
+  switch (entity) {
+    case Entity::CELL: return "cell";
+    case Entity::FACE: return "face";
+    default: return "scalar";
+  }
+}
+
+
+void
+State::WriteDot(const std::string& filename) const {
+  std::ofstream out(filename);
+  if (!out) {
+    std::cout << "State: cannot write " << filename << std::endl;
+    throw("State: cannot write DAG file");
+  }
+  auto critical_keys = CriticalPath();
+  std::set<std::string> critical(critical_keys.begin(), critical_keys.end());
+
+  out << "digraph arcos {" << std::endl
+      << "  rankdir=BT;" << std::endl
+      << "  node [shape=box, style=filled, fillcolor=white];" << std::endl;
+
+  // one cluster per field group, so that co-located fields are drawn together
+  for (size_t g = 0; g != field_groups.size(); ++g) {
+    out << "  subgraph cluster_" << g << " {" << std::endl
+        << "    label=\"group " << g << "\"; style=dashed;" << std::endl;
+    for (const auto& key : field_groups[g].keys) {
+      out << "    \"" << key << "\" [label=\"" << key
+          << "\\ncost " << Cost_(*this, key)
+          << "\\n" << Bytes_(key) / 1.e6 << " MB";
+      if (uniform.count(key)) out << "\\nuniform = " << uniform.at(key);
+      else if (storage.at(key) != key) out << "\\nuses " << storage.at(key);
+      out << "\"";
+      if (critical.count(key)) out << ", color=red, penwidth=2";
+      if (uniform.count(key)) out << ", fillcolor=lightgray";
+      out << "];" << std::endl;
+    }
+    out << "  }" << std::endl;
+  }
+
+  // scalars belong to no group
+  for (const auto& ent : entities) {
+    if (ent.second != Entity::SCALAR) continue;
+    const auto& key = ent.first;
+    out << "  \"" << key << "\" [shape=ellipse, label=\"" << key
+        << "\\ncost " << Cost_(*this, key);
+    if (uniform.count(key)) out << "\\nuniform = " << uniform.at(key);
+    out << "\"";
+    if (critical.count(key)) out << ", color=red, penwidth=2";
+    if (uniform.count(key)) out << ", fillcolor=lightgray";
+    out << "];" << std::endl;
+  }
+
+  for (const auto& eval : evaluators) {
+    for (const auto& dep : eval.second->Dependencies()) {
+      out << "  \"" << dep << "\" -> \"" << eval.first << "\"";
+      if (critical.count(dep) && critical.count(eval.first)) out << " [color=red, penwidth=2]";
+      out << ";" << std::endl;
+    }
+  }
+  out << "}" << std::endl;
+}
+
+
+void
+State::WriteJson(const std::string& filename) const {
+  std::ofstream out(filename);
+  if (!out) {
+    std::cout << "State: cannot write " << filename << std::endl;
+    throw("State: cannot write DAG file");
+  }
+  auto critical_keys = CriticalPath();
+  std::set<std::string> critical(critical_keys.begin(), critical_keys.end());
+
+  out << "{" << std::endl << "  \"nodes\": [" << std::endl;
+  bool first = true;
+  for (const auto& key : plan_keys) {
+    if (!first) out << "," << std::endl;
+    first = false;
+    out << "    {\"key\": \"" << key << "\""
+        << ", \"entity\": \"" << EntityName_(entities.at(key)) << "\""
+        << ", \"cost\": " << Cost_(*this, key)
+        << ", \"bytes\": " << Bytes_(key)
+        << ", \"group\": " << (group_ids.count(key) ? group_ids.at(key) : -1)
+        << ", \"storage\": \"" << (storage.count(key) ? storage.at(key) : "") << "\""
+        << ", \"priority\": " << Priority(key)
+        << ", \"critical\": " << (critical.count(key) ? "true" : "false");
+    if (uniform.count(key)) out << ", \"uniform\": " << uniform.at(key);
+    out << "}";
+  }
+  out << std::endl << "  ]," << std::endl << "  \"edges\": [" << std::endl;
+  first = true;
+  for (const auto& eval : evaluators) {
+    for (const auto& dep : eval.second->Dependencies()) {
+      if (!first) out << "," << std::endl;
+      first = false;
+      out << "    [\"" << dep << "\", \"" << eval.first << "\"]";
+    }
+  }
+  out << std::endl << "  ]," << std::endl << "  \"critical_path\": [";
+  for (size_t i = 0; i != critical_keys.size(); ++i)
+    out << (i ? ", " : "") << "\"" << critical_keys[i] << "\"";
+  out << "]" << std::endl << "}" << std::endl;
+}
+
+} // namespace Arcos
@@ -0,0 +1,75 @@
+//! --------------------------------------------------------------------------------
+//
+// Arcos -- Legion
+//
+// Author: Ethan Coon (coonet@ornl.gov)
+// License: BSD
+//
+// Non-templated task managers.
+//
+// ---------------------------------------------------------------------------------
+
+#include <cstring>
+#include "task_managers.hh"
+
+namespace Arcos {
+
+// implementation of inner
+// ------------------------------------------------------------------
+Legion::TaskID TaskManagerInner::taskid = 0;
+
+void
+TaskManagerInner::preregister_task(Legion::TaskID new_taskid)
+{
+  taskid = ((new_taskid == AUTO_GENERATE_ID) ?
+	    Legion::Runtime::generate_static_task_id() :
+	      new_taskid);
+  Legion::TaskVariantRegistrar tvr(taskid, "inner_plan");
+  tvr.add_constraint(Legion::ProcessorConstraint(Legion::Processor::LOC_PROC));
+  tvr.set_inner(true);
+  Legion::Runtime::preregister_task_variant<&TaskManagerInner::cpu_task>(tvr, "inner_plan");
+}
+
+
+void
+TaskManagerInner::cpu_task(const Legion::Task *task,
+                           const std::vector<Legion::PhysicalRegion> &regions,
+                           Legion::Context ctx, Legion::Runtime *runtime)
+{
+  assert(task->arglen >= sizeof(InnerHeader));
+  InnerHeader header;
+  std::memcpy(&header, task->args, sizeof(InnerHeader));
+  assert(task->arglen == sizeof(InnerHeader) + header.nentries*sizeof(PlanEntry));
+  std::vector<PlanEntry> entries(header.nentries);
+  std::memcpy(entries.data(), (const char*) task->args + sizeof(InnerHeader),
+              header.nentries*sizeof(PlanEntry));
+
+  // every group shares the cells of this coarse tile, so one fine
+  // partition serves them all
+  auto tile = task->regions[0].region.get_index_space();
+  auto domain = runtime->get_index_space_domain(ctx, tile);
+  auto fine = runtime->create_index_space(ctx,
+          StructuredDomain(BlockedColors(Extents(domain), header.nfine)));
+  auto fine_ip = runtime->create_equal_partition(ctx, tile, fine);
+
+  std::vector<Legion::LogicalPartition> partitions;
+  std::vector<Legion::LogicalRegion> parents;
+  for (const auto& req : task->regions) {
+    parents.push_back(req.region);
+    partitions.push_back(runtime->get_logical_partition(ctx, req.region, fine_ip));
+  }
+
+  for (const auto& entry : entries) {
+    if (entry.uniform) continue;
+    Legion::IndexLauncher launcher(entry.taskid, fine, PlanArgument(entry), Legion::ArgumentMap());
+    launcher.tag = PriorityTag(entry.priority);
+    AddRequirements(entry, launcher, partitions, parents);
+    runtime->execute_index_space(ctx, launcher);
+  }
+
+  // deferred until the launches above are done with them
+  runtime->destroy_index_partition(ctx, fine_ip);
+  runtime->destroy_index_space(ctx, fine);
+}
+
+} // namespace Arcos
@@ -12,7 +12,7 @@
 //   static Legion::TaskID taskid;
 //   static void preregister_task(Legion::TaskID new_taskid = AUTO_GENERATE_ID);
 //   static Legion::Future compute(Legion::Context ctx, Legion::Runtime *runtime, ...);
-//   static double cpu_task(const Legion::Task *task,
+//   static TaskStats cpu_task(const Legion::Task *task,
 // 		        const std::vector<Legion::PhysicalRegion> &regions,
 // 		        Legion::Context ctx, Legion::Runtime *runtime);
 // };
@@ -28,7 +28,9 @@
 // a task is passed off to the runtime queue.
 //
 // cpu_task() should be the actual task implementation, which unpacks
-// the futures/args and does the work.
+// the futures/args and does the work.  It returns TaskStats, its elapsed
+// time in seconds and the bytes it moved, which State uses to balance
+// load across colors and to report on each evaluator.
 //
 // Note cpu_task() is the only one whose interface is fixed by Legion.
 //
@@ -37,13 +39,31 @@
 #ifndef ARCOS_TASK_MANAGERS_HH_
 #define ARCOS_TASK_MANAGERS_HH_
 
+#include <chrono>
 #include "legion.h"
 #include "template_magic.hh"
+#include "partitioning.hh"
+#include "mesh.hh"
+#include "launch_plan.hh"
+#include "perf_counters.hh"
+#include "reductions.hh"
+#include "input_args.hh"
 
 namespace LHL = LegionRuntime::HighLevel;
 
 namespace Arcos {
 
+//
+// What a leaf task reports back through its future.
+// =============================================================================
+struct TaskStats {
+  double time;          // elapsed seconds
+  double bytes_read;    // bytes of field data read
+  double bytes_written; // bytes of field data written
+  PerfSample counters;  // hardware counters, if enabled (-arcos:perf)
+  double value;         // a reduction task's contribution of its tile
+};
+
 
 //
 // A task manager for primary variables
@@ -56,9 +76,14 @@ struct TaskManagerPrimary {
                              Legion::Runtime *runtime,
                              const Legion::TaskLauncher& launcher,
                              const Data_t& value);
-  static void cpu_task(const Legion::Task *task,
+  static TaskStats cpu_task(const Legion::Task *task,
 			   const std::vector<Legion::PhysicalRegion> &regions,
 			   Legion::Context ctx, Legion::Runtime *runtime);
+
+  // the work of cpu_task(), for a domain of dimension DIM
+  template<int DIM>
+  static void cpu_task_dim(const Legion::PhysicalRegion& region, Legion::FieldID fid,
+                           const Legion::Domain& domain, const Data_t& val);
 };
 
 
@@ -72,6 +97,112 @@ struct TaskManagerSecondary {
   static Legion::Future compute(Legion::Context ctx, Legion::Runtime *runtime,
                              const Legion::TaskLauncher& launcher,
 			     const Func_t& func);
+
+  // the function of uniform arguments, evaluated once on the host
+  static double evaluate(const std::vector<double>& values);
+  template<int... S>
+  static double evaluate_(const std::vector<double>& values, Magic::seq<S...>);
+
+  static TaskStats cpu_task(const Legion::Task *task,
+                       const std::vector<Legion::PhysicalRegion> &regions,
+                       Legion::Context ctx, Legion::Runtime *runtime);
+
+  // the work of cpu_task(), for a domain of dimension DIM
+  template<int DIM>
+  static void cpu_task_dim(const Legion::Task *task,
+                           const std::vector<Legion::PhysicalRegion> &regions,
+                           const Legion::Domain& domain);
+};
+
+
+//
+// A task manager for secondary variables on faces, whose function takes
+// the arguments on both adjacent cells, i.e. func(args0..., args1...)
+// =============================================================================
+template<typename Func_t, typename... Args>
+struct TaskManagerFace {
+  static Legion::TaskID taskid;
+  static void preregister_task(Legion::TaskID new_taskid = AUTO_GENERATE_ID);
+
+  // the function of uniform arguments, the same on both sides
+  static double evaluate(const std::vector<double>& values);
+  template<int... S>
+  static double evaluate_(const std::vector<double>& values, Magic::seq<S...>);
+
+  static TaskStats cpu_task(const Legion::Task *task,
+                       const std::vector<Legion::PhysicalRegion> &regions,
+                       Legion::Context ctx, Legion::Runtime *runtime);
+};
+
+
+//
+// A task manager for global reductions of a field to a scalar, as given
+// by Reduce_t (see reductions.hh).  Each color returns TaskStats, like
+// any other launch, carrying its tile's contribution as the value; the
+// runtime reduces the colors with ValueReduction into one future.
+// =============================================================================
+template<typename Reduce_t>
+struct TaskManagerReduction {
+  // folds the value of the colors' TaskStats with Reduce_t; their other
+  // stats are not combined
+  struct ValueReduction {
+    typedef TaskStats LHS;
+    typedef TaskStats RHS;
+    static const TaskStats identity;
+
+    template<bool EXCLUSIVE> static void apply(LHS& lhs, RHS rhs) {
+      if (EXCLUSIVE) lhs.value = Reduce_t::Fold(lhs.value, rhs.value);
+      else AtomicFold(lhs.value, rhs.value, Reduce_t::Fold);
+    }
+    template<bool EXCLUSIVE> static void fold(RHS& rhs1, RHS rhs2) {
+      apply<EXCLUSIVE>(rhs1, rhs2);
+    }
+  };
+
+  static Legion::TaskID taskid;
+  static Legion::TaskID finish_taskid;
+  static Legion::ReductionOpID redop; // of ValueReduction
+  static void preregister_task(Legion::TaskID new_taskid = AUTO_GENERATE_ID);
+
+  // the reduction of n entries all equal to value, evaluated on the host
+  static double evaluate(double value, double n);
+
+  // the scalar: the colors of launch reduced by the runtime, then
+  // finished by a task, which also unwraps the value of the reduced
+  // TaskStats, so that nothing waits on the reduction
+  static Legion::Future reduce(Legion::Context ctx, Legion::Runtime *runtime,
+                               const Legion::FutureMap& launch);
+
+  static TaskStats cpu_task(const Legion::Task *task,
+                         const std::vector<Legion::PhysicalRegion> &regions,
+                         Legion::Context ctx, Legion::Runtime *runtime);
+
+  // the work of cpu_task(), for a domain of dimension DIM
+  template<int DIM>
+  static double cpu_task_dim(const Legion::Task *task,
+                             const std::vector<Legion::PhysicalRegion> &regions,
+                             const Legion::Domain& domain);
+
+  static double finish_task(const Legion::Task *task,
+                            const std::vector<Legion::PhysicalRegion> &regions,
+                            Legion::Context ctx, Legion::Runtime *runtime);
+};
+
+
+//
+// A task manager for the inner tasks of a hierarchical State, which
+// replay part of the launch plan over a fine partition of their coarse
+// tile.  The task argument is an InnerHeader followed by nentries
+// PlanEntrys, and there is one region requirement per field group.
+// =============================================================================
+struct InnerHeader {
+  long long nfine;
+  int nentries;
+};
+
+struct TaskManagerInner {
+  static Legion::TaskID taskid;
+  static void preregister_task(Legion::TaskID new_taskid = AUTO_GENERATE_ID);
   static void cpu_task(const Legion::Task *task,
                        const std::vector<Legion::PhysicalRegion> &regions,
                        Legion::Context ctx, Legion::Runtime *runtime);
@@ -12,7 +12,7 @@
 //   static Legion::TaskID taskid;
 //   static void preregister_task(Legion::TaskID new_taskid = AUTO_GENERATE_ID);
 //   static Legion::Future compute(Legion::Context ctx, Legion::Runtime *runtime, ...);
-//   static double cpu_task(const Legion::Task *task,
+//   static TaskStats cpu_task(const Legion::Task *task,
 // 		        const std::vector<Legion::PhysicalRegion> &regions,
 // 		        Legion::Context ctx, Legion::Runtime *runtime);
 // };
@@ -28,7 +28,9 @@
 // a task is passed off to the runtime queue.
 //
 // cpu_task() should be the actual task implementation, which unpacks
-// the futures/args and does the work.
+// the futures/args and does the work.  It returns TaskStats, its elapsed
+// time in seconds and the bytes it moved, which State uses to balance
+// load across colors and to report on each evaluator.
 //
 // Note cpu_task() is the only one whose interface is fixed by Legion.
 //
@@ -50,16 +52,17 @@ TaskManagerPrimary<Data_t>::preregister_task(Legion::TaskID new_taskid)
   //  std::cout << "Registering task: primary_variable" << std::endl;
   tvr.add_constraint(Legion::ProcessorConstraint(Legion::Processor::LOC_PROC));
   tvr.set_leaf(true);
-  Legion::Runtime::preregister_task_variant<&TaskManagerPrimary<Data_t>::cpu_task>(tvr, "primary_variable");
+  Legion::Runtime::preregister_task_variant<TaskStats, &TaskManagerPrimary<Data_t>::cpu_task>(tvr, "primary_variable");
 }
 
 template<typename Data_t>
-void
+TaskStats
 TaskManagerPrimary<Data_t>::cpu_task(const Legion::Task *task,
 				       const std::vector<Legion::PhysicalRegion> &regions,
 				       Legion::Context ctx, Legion::Runtime *runtime)
 {
-  std::cout << "Executing primary task...";
+  auto start = std::chrono::steady_clock::now();
+  if (Verbose()) std::cout << "Executing primary task...";
   assert(regions.size() == 1);
   assert(task->regions.size() == 1);
   assert(task->regions[0].privilege_fields.size() == 1);
@@ -69,11 +72,36 @@ TaskManagerPrimary<Data_t>::cpu_task(const Legion::Task *task,
   // This is a field polymorphic function so figure out
   // which field we are responsible for initializing.
   auto fid = *(task->regions[0].privilege_fields.begin());
-  printf("Initializing (field %d) = %g\n", fid, val);
+  if (Verbose()) printf("Initializing (field %d) = %g\n", fid, val);
 
-  const Legion::FieldAccessor<WRITE_DISCARD,double,1> acc(regions[0], fid);
   auto domain = runtime->get_index_space_domain(ctx, task->regions[0].region.get_index_space());
-  for (Legion::PointInRectIterator<1> p(domain); p(); ++p) acc[*p] = val;
+  switch (domain.get_dim()) {
+    case 1: cpu_task_dim<1>(regions[0], fid, domain, val); break;
+#if ARCOS_MAX_DIM >= 2
+    case 2: cpu_task_dim<2>(regions[0], fid, domain, val); break;
+#endif
+#if ARCOS_MAX_DIM >= 3
+    case 3: cpu_task_dim<3>(regions[0], fid, domain, val); break;
+#endif
+    default: assert(false);
+  }
+
+  TaskStats stats{};
+  stats.time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  stats.bytes_read = 0.;
+  stats.bytes_written = domain.get_volume() * sizeof(Data_t);
+  stats.counters = {-1., -1., -1., -1.};
+  return stats;
+}
+
+template<typename Data_t>
+template<int DIM>
+void
+TaskManagerPrimary<Data_t>::cpu_task_dim(const Legion::PhysicalRegion& region, Legion::FieldID fid,
+                                         const Legion::Domain& domain, const Data_t& val)
+{
+  const Legion::FieldAccessor<WRITE_DISCARD,double,DIM> acc(region, fid);
+  for (Legion::PointInRectIterator<DIM> p(domain); p(); ++p) acc[*p] = val;
 }
 
 template<typename Data_t>
@@ -98,72 +126,407 @@ TaskManagerSecondary<Func_t, Args...>
   Legion::TaskVariantRegistrar tvr(taskid, Func_t::name);
   tvr.add_constraint(Legion::ProcessorConstraint(Legion::Processor::LOC_PROC));
   tvr.set_leaf(true);
-  Legion::Runtime::preregister_task_variant<&TaskManagerSecondary<Func_t,Args...>::cpu_task>(tvr, Func_t::name);
+  Legion::Runtime::preregister_task_variant<TaskStats, &TaskManagerSecondary<Func_t,Args...>::cpu_task>(tvr, Func_t::name);
 }
 
 
-template<typename Accessor_iter_t, typename T>
-T readAccessor(Accessor_iter_t& a, Legion::PointInRectIterator<1> i)
+// an argument: a field, or a single value if it is uniform or a scalar
+template<int DIM>
+struct ArgReader {
+  const Legion::FieldAccessor<READ_ONLY,double,DIM>* accessor; // null if a value
+  double value;
+
+  double operator[](const Legion::Point<DIM>& p) const {
+    return accessor ? (*accessor)[p] : value;
+  }
+};
+
+// readers for the arguments of an entry, finding each field in the
+// region requirements from first_region on, and each scalar in the
+// task's futures
+template<int DIM>
+std::vector<ArgReader<DIM> >
+argReaders(const PlanEntry& entry, const Legion::Task *task,
+           const std::vector<Legion::PhysicalRegion> &regions, int first_region,
+           std::vector<Legion::FieldAccessor<READ_ONLY,double,DIM> >& accessors)
+{
+  // reserved so that the readers' pointers stay valid
+  accessors.reserve(entry.nargs);
+  std::vector<ArgReader<DIM> > readers(entry.nargs);
+  int nscalars = 0;
+  for (int i = 0; i != entry.nargs; ++i) {
+    if (entry.arg_uniform[i]) {
+      readers[i].accessor = nullptr;
+      readers[i].value = entry.arg_values[i];
+    } else if (entry.arg_scalar[i]) {
+      // the launch waited on the future, so this does not block
+      assert(nscalars < (int) task->futures.size());
+      readers[i].accessor = nullptr;
+      readers[i].value = task->futures[nscalars++].get_result<double>();
+    } else {
+      Legion::FieldID fid = entry.arg_fids[i];
+      int r = first_region;
+      while (r < (int) regions.size() && task->regions[r].privilege_fields.count(fid) == 0) ++r;
+      assert(r < (int) regions.size());
+      accessors.emplace_back(Legion::FieldAccessor<READ_ONLY,double,DIM>(regions[r], fid));
+      readers[i].accessor = &accessors.back();
+      readers[i].value = 0.;
+    }
+  }
+  return readers;
+}
+
+
+template<typename Accessor_iter_t, typename T, int DIM>
+T readAccessor(Accessor_iter_t& a, const Legion::Point<DIM>& p)
 {
-  T t = (*a)[*i];
+  T t = (*a)[p];
   a++;
   return std::move(t);
 }
 
 // read a vector of futures and return a tuple of their results
-template<typename Accessor_iter_t, typename... Args>
-std::tuple<Args...> accessorsToValues(Accessor_iter_t a, Legion::PointInRectIterator<1> i)
+template<typename Accessor_iter_t, int DIM, typename... Args>
+std::tuple<Args...> accessorsToValues(Accessor_iter_t a, const Legion::Point<DIM>& p)
 {
-  return std::make_tuple(readAccessor<Accessor_iter_t,Args>(a,i)...);
+  return std::make_tuple(readAccessor<Accessor_iter_t,Args,DIM>(a,p)...);
 }
 
 
 template<typename Func_t, typename... Args>
-void
+TaskStats
 TaskManagerSecondary<Func_t,Args...>
 ::cpu_task(const Legion::Task *task,
 	   const std::vector<Legion::PhysicalRegion> &regions,
 	   Legion::Context ctx, Legion::Runtime *runtime)
 {
-  std::cout << "Executing secondary task...";
-  assert(regions.size() == 2);
-  assert(task->regions.size() == 2);
+  auto start = std::chrono::steady_clock::now();
+  bool counting = PerfCounters::Enabled();
+  if (counting) PerfCounters::Thread().Start();
+  if (Verbose()) std::cout << "Executing secondary task...";
+  constexpr int nargs = std::tuple_size<std::tuple<Args...> >::value;
+  assert(regions.size() >= 1);
+  assert(task->regions.size() == regions.size());
   assert(task->regions[0].privilege_fields.size() == 1);
-  assert(task->regions[1].privilege_fields.size() == std::tuple_size<std::tuple<Args...> >::value);
+  assert(task->arglen == sizeof(PlanEntry));
+  assert(((const PlanEntry*) task->args)->nargs == nargs);
 
-  // get the function
-  const Func_t& func= *(const Func_t*)(task->args);
+  auto domain = runtime->get_index_space_domain(ctx, task->regions[0].region.get_index_space());
+  switch (domain.get_dim()) {
+    case 1: cpu_task_dim<1>(task, regions, domain); break;
+#if ARCOS_MAX_DIM >= 2
+    case 2: cpu_task_dim<2>(task, regions, domain); break;
+#endif
+#if ARCOS_MAX_DIM >= 3
+    case 3: cpu_task_dim<3>(task, regions, domain); break;
+#endif
+    default: assert(false);
+  }
+
+  const PlanEntry& entry = *(const PlanEntry*) task->args;
+  int nfields = 0;
+  for (int i = 0; i != entry.nargs; ++i)
+    if (!entry.arg_uniform[i] && !entry.arg_scalar[i]) nfields++;
+  TaskStats stats{};
+  stats.counters = counting ? PerfCounters::Thread().Stop() : PerfSample{-1., -1., -1., -1.};
+  stats.time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  stats.bytes_read = nfields * domain.get_volume() * sizeof(double);
+  stats.bytes_written = domain.get_volume() * sizeof(double);
+  return stats;
+}
+
+
+template<typename Func_t, typename... Args>
+template<int DIM>
+void
+TaskManagerSecondary<Func_t,Args...>
+::cpu_task_dim(const Legion::Task *task,
+               const std::vector<Legion::PhysicalRegion> &regions,
+               const Legion::Domain& domain)
+{
+  // functions are stateless
+  Func_t func;
 
   // get a list of accessors for the argument
   // NOTE: these will likely perform poorly and need better accessors.  Pointer magic is sufficient. See also:
   // https://groups.google.com/forum/#!topic/legionusers/dhLmnDCiu6A
   // and
   // https://groups.google.com/forum/#!topic/legionusers/4kz95IKTNxw
-  std::vector<Legion::FieldAccessor<READ_ONLY,double,1>> fas_in;
-  std::cout << " depending upon FIDs: ";
-  for (auto fid : task->regions[1].instance_fields) {
-    std::cout << (int) fid << " ";
-    fas_in.emplace_back(Legion::FieldAccessor<READ_ONLY,double,1>(regions[1], fid));
+  //
+  // The arguments' field IDs are passed in order, and each may live in
+  // any of the read-only region requirements (one per field group).
+  // Uniform arguments are passed by value.
+  const PlanEntry& entry = *(const PlanEntry*) task->args;
+  if (Verbose()) {
+    std::cout << " depending upon FIDs: ";
+    for (int i = 0; i != entry.nargs; ++i) {
+      if (entry.arg_uniform[i]) std::cout << "(" << entry.arg_values[i] << ") ";
+      else if (entry.arg_scalar[i]) std::cout << "(scalar) ";
+      else std::cout << (int) entry.arg_fids[i] << " ";
+    }
+    std::cout << std::endl;
   }
+  std::vector<Legion::FieldAccessor<READ_ONLY,double,DIM>> accessors;
+  auto fas_in = argReaders<DIM>(entry, task, regions, 1, accessors);
 
   // get the accessor for the output
-  const Legion::FieldAccessor<WRITE_DISCARD,double,1> fa_out(regions[0], *task->regions[0].privilege_fields.begin());
+  const Legion::FieldAccessor<WRITE_DISCARD,double,DIM> fa_out(regions[0], *task->regions[0].privilege_fields.begin());
 
   // iterate and invoke the function
-  auto domain = runtime->get_index_space_domain(ctx, task->regions[0].region.get_index_space());
-  for (Legion::PointInRectIterator<1> p(domain); p(); ++p) {
+  for (Legion::PointInRectIterator<DIM> p(domain); p(); ++p) {
     // note there is almost definitely a more efficient way to do this, but for now this is easy.  Pack a tuple then invoke. --etc
-    auto values = accessorsToValues<std::vector<Legion::FieldAccessor<READ_ONLY,double,1>>::const_iterator, Args...>(fas_in.begin(), p);
+    auto values = accessorsToValues<typename std::vector<ArgReader<DIM> >::const_iterator, DIM, Args...>(fas_in.begin(), *p);
     fa_out[*p] = Arcos::Magic::invoke<double>(func, values);
-    std::cout << ", got: " << (double) fa_out[*p] << std::endl;
   }
 }
 
 
+template<typename Func_t, typename... Args>
+double
+TaskManagerSecondary<Func_t,Args...>::evaluate(const std::vector<double>& values)
+{
+  assert(values.size() == sizeof...(Args));
+  return evaluate_(values, typename Magic::gens<sizeof...(Args)>::type());
+}
+
+template<typename Func_t, typename... Args>
+template<int... S>
+double
+TaskManagerSecondary<Func_t,Args...>::evaluate_(const std::vector<double>& values, Magic::seq<S...>)
+{
+  Func_t func;
+  return func(values[S]...);
+}
+
+
 template<typename Func_t, typename... Args>
 Legion::TaskID TaskManagerSecondary<Func_t,Args...>::taskid = 0;
 
 
 
+// implementation of Face
+// ------------------------------------------------------------------
+template<typename Func_t, typename... Args>
+void
+TaskManagerFace<Func_t, Args...>
+::preregister_task(Legion::TaskID new_taskid)
+{
+  taskid = ((new_taskid == AUTO_GENERATE_ID) ?
+  	      Legion::Runtime::generate_static_task_id() :
+	      new_taskid);
+  std::cout << "Registering task: " << Func_t::name << std::endl;
+  Legion::TaskVariantRegistrar tvr(taskid, Func_t::name);
+  tvr.add_constraint(Legion::ProcessorConstraint(Legion::Processor::LOC_PROC));
+  tvr.set_leaf(true);
+  Legion::Runtime::preregister_task_variant<TaskStats, &TaskManagerFace<Func_t,Args...>::cpu_task>(tvr, Func_t::name);
+}
+
+
+template<typename Func_t, typename... Args>
+TaskStats
+TaskManagerFace<Func_t,Args...>
+::cpu_task(const Legion::Task *task,
+	   const std::vector<Legion::PhysicalRegion> &regions,
+	   Legion::Context ctx, Legion::Runtime *runtime)
+{
+  auto start = std::chrono::steady_clock::now();
+  bool counting = PerfCounters::Enabled();
+  if (counting) PerfCounters::Thread().Start();
+  if (Verbose()) std::cout << "Executing face task...";
+  constexpr int nargs = std::tuple_size<std::tuple<Args...> >::value;
+  assert(regions.size() >= 2);
+  assert(task->regions.size() == regions.size());
+  assert(task->regions[0].privilege_fields.size() == 1);
+  assert(task->arglen == sizeof(PlanEntry));
+  assert(((const PlanEntry*) task->args)->nargs == nargs);
+
+  // functions are stateless
+  Func_t func;
+
+  // the adjacency
+  const Legion::FieldAccessor<READ_ONLY,Legion::Point<1>,1> cell0(regions[1], FID_FACE_CELL0);
+  const Legion::FieldAccessor<READ_ONLY,Legion::Point<1>,1> cell1(regions[1], FID_FACE_CELL1);
+
+  // the arguments, on owned and ghost cells
+  const PlanEntry& entry = *(const PlanEntry*) task->args;
+  std::vector<Legion::FieldAccessor<READ_ONLY,double,1>> accessors;
+  auto fas_in = argReaders<1>(entry, task, regions, 2, accessors);
+
+  // get the accessor for the output
+  const Legion::FieldAccessor<WRITE_DISCARD,double,1> fa_out(regions[0], *task->regions[0].privilege_fields.begin());
+
+  // iterate over faces and invoke the function on both sides
+  typedef typename std::vector<ArgReader<1> >::const_iterator Iter_t;
+  auto domain = runtime->get_index_space_domain(ctx, task->regions[0].region.get_index_space());
+  for (Legion::PointInRectIterator<1> f(domain); f(); ++f) {
+    auto values = std::tuple_cat(accessorsToValues<Iter_t, 1, Args...>(fas_in.begin(), cell0[*f]),
+            accessorsToValues<Iter_t, 1, Args...>(fas_in.begin(), cell1[*f]));
+    fa_out[*f] = Arcos::Magic::invoke<double>(func, values);
+  }
+  if (Verbose()) std::cout << " done." << std::endl;
+
+  // both adjacent cells of each face, and the adjacency itself
+  int nfields = 0;
+  for (int i = 0; i != entry.nargs; ++i)
+    if (!entry.arg_uniform[i] && !entry.arg_scalar[i]) nfields++;
+  TaskStats stats{};
+  stats.counters = counting ? PerfCounters::Thread().Stop() : PerfSample{-1., -1., -1., -1.};
+  stats.time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  stats.bytes_read = domain.get_volume() * (2*nfields*sizeof(double) + 2*sizeof(Legion::Point<1>));
+  stats.bytes_written = domain.get_volume() * sizeof(double);
+  return stats;
+}
+
+
+template<typename Func_t, typename... Args>
+double
+TaskManagerFace<Func_t,Args...>::evaluate(const std::vector<double>& values)
+{
+  assert(values.size() == sizeof...(Args));
+  return evaluate_(values, typename Magic::gens<sizeof...(Args)>::type());
+}
+
+template<typename Func_t, typename... Args>
+template<int... S>
+double
+TaskManagerFace<Func_t,Args...>::evaluate_(const std::vector<double>& values, Magic::seq<S...>)
+{
+  Func_t func;
+  return func(values[S]..., values[S]...);
+}
+
+
+template<typename Func_t, typename... Args>
+Legion::TaskID TaskManagerFace<Func_t,Args...>::taskid = 0;
+
+
+
+// implementation of Reduction
+// ------------------------------------------------------------------
+template<typename Reduce_t>
+void
+TaskManagerReduction<Reduce_t>::preregister_task(Legion::TaskID new_taskid)
+{
+  taskid = ((new_taskid == AUTO_GENERATE_ID) ?
+  	      Legion::Runtime::generate_static_task_id() :
+	      new_taskid);
+  std::cout << "Registering task: " << Reduce_t::name << std::endl;
+  Legion::TaskVariantRegistrar tvr(taskid, Reduce_t::name);
+  tvr.add_constraint(Legion::ProcessorConstraint(Legion::Processor::LOC_PROC));
+  tvr.set_leaf(true);
+  Legion::Runtime::preregister_task_variant<TaskStats, &TaskManagerReduction<Reduce_t>::cpu_task>(tvr, Reduce_t::name);
+
+  finish_taskid = Legion::Runtime::generate_static_task_id();
+  Legion::TaskVariantRegistrar ftvr(finish_taskid, "reduction_finish");
+  ftvr.add_constraint(Legion::ProcessorConstraint(Legion::Processor::LOC_PROC));
+  ftvr.set_leaf(true);
+  Legion::Runtime::preregister_task_variant<double, &TaskManagerReduction<Reduce_t>::finish_task>(ftvr, "reduction_finish");
+
+  redop = Legion::Runtime::generate_static_reduction_id();
+  Legion::Runtime::register_reduction_op<ValueReduction>(redop);
+}
+
+
+template<typename Reduce_t>
+double
+TaskManagerReduction<Reduce_t>::evaluate(double value, double n)
+{
+  return Reduce_t::Uniform(value, n);
+}
+
+
+template<typename Reduce_t>
+Legion::Future
+TaskManagerReduction<Reduce_t>::reduce(Legion::Context ctx, Legion::Runtime *runtime,
+                                       const Legion::FutureMap& launch)
+{
+  Legion::TaskLauncher launcher(finish_taskid, Legion::TaskArgument());
+  launcher.add_future(runtime->reduce_future_map(ctx, launch, redop));
+  return runtime->execute_task(ctx, launcher);
+}
+
+
+template<typename Reduce_t>
+TaskStats
+TaskManagerReduction<Reduce_t>::cpu_task(const Legion::Task *task,
+                                         const std::vector<Legion::PhysicalRegion> &regions,
+                                         Legion::Context ctx, Legion::Runtime *runtime)
+{
+  auto start = std::chrono::steady_clock::now();
+  bool counting = PerfCounters::Enabled();
+  if (counting) PerfCounters::Thread().Start();
+  if (Verbose()) std::cout << "Executing reduction task " << Reduce_t::name << std::endl;
+  assert(regions.size() == 1);
+  assert(task->regions.size() == 1);
+  assert(task->arglen == sizeof(PlanEntry));
+  assert(((const PlanEntry*) task->args)->nargs == 1);
+
+  auto domain = runtime->get_index_space_domain(ctx, task->regions[0].region.get_index_space());
+  TaskStats stats{};
+  stats.value = Reduce_t::Identity();
+  switch (domain.get_dim()) {
+    case 1: stats.value = cpu_task_dim<1>(task, regions, domain); break;
+#if ARCOS_MAX_DIM >= 2
+    case 2: stats.value = cpu_task_dim<2>(task, regions, domain); break;
+#endif
+#if ARCOS_MAX_DIM >= 3
+    case 3: stats.value = cpu_task_dim<3>(task, regions, domain); break;
+#endif
+    default: assert(false);
+  }
+
+  stats.counters = counting ? PerfCounters::Thread().Stop() : PerfSample{-1., -1., -1., -1.};
+  stats.time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  stats.bytes_read = domain.get_volume() * sizeof(double);
+  stats.bytes_written = 0.;
+  return stats;
+}
+
+
+template<typename Reduce_t>
+template<int DIM>
+double
+TaskManagerReduction<Reduce_t>::cpu_task_dim(const Legion::Task *task,
+                                             const std::vector<Legion::PhysicalRegion> &regions,
+                                             const Legion::Domain& domain)
+{
+  const PlanEntry& entry = *(const PlanEntry*) task->args;
+  std::vector<Legion::FieldAccessor<READ_ONLY,double,DIM>> accessors;
+  auto fas_in = argReaders<DIM>(entry, task, regions, 0, accessors);
+
+  // this tile's contribution, which the runtime folds with the others
+  double result = Reduce_t::Identity();
+  for (Legion::PointInRectIterator<DIM> p(domain); p(); ++p)
+    result = Reduce_t::Fold(result, Reduce_t::Map(fas_in[0][*p]));
+  return result;
+}
+
+
+template<typename Reduce_t>
+double
+TaskManagerReduction<Reduce_t>::finish_task(const Legion::Task *task,
+                                            const std::vector<Legion::PhysicalRegion> &regions,
+                                            Legion::Context ctx, Legion::Runtime *runtime)
+{
+  assert(task->futures.size() == 1);
+  return Reduce_t::Finish(task->futures[0].get_result<TaskStats>().value);
+}
+
+
+template<typename Reduce_t>
+Legion::TaskID TaskManagerReduction<Reduce_t>::taskid = 0;
+
+template<typename Reduce_t>
+Legion::TaskID TaskManagerReduction<Reduce_t>::finish_taskid = 0;
+
+template<typename Reduce_t>
+Legion::ReductionOpID TaskManagerReduction<Reduce_t>::redop = 0;
+
+template<typename Reduce_t>
+const TaskStats TaskManagerReduction<Reduce_t>::ValueReduction::identity =
+    {0., 0., 0., PerfSample{-1., -1., -1., -1.}, Reduce_t::Identity()};
+
+
+
 
 } // namespace
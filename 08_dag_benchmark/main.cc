@@ -0,0 +1,145 @@
+//! --------------------------------------------------------------------------------
+//
+// Arcos -- Legion
+//
+// Author: Ethan Coon (coonet@ornl.gov)
+// License: BSD
+//
+// Scheduling overhead benchmark: runs synthetic evaluator DAGs through
+// State and measures, per step,
+//
+//   * host time: issuing every launch of the plan from the top level task
+//   * step time: from the first launch issued to the last task done
+//   * busy time: the summed task time of every color of every launch
+//   * parallelism: busy / step time, the cores kept busy on average
+//   * overhead per launch: the step time beyond that of the busy time
+//     spread perfectly over all cores, per launch
+//
+// Options:
+//   -dag layered|random  shape of the DAG (layered)
+//   -width N             keys per layer (8)
+//   -depth N             layers, including that of primaries (8)
+//   -fan_in N            keys read by each secondary (2)
+//   -cells N             cells in the domain (1000)
+//   -work N              floating point operations per cell (0)
+//   -steps N             timed steps, after one untimed step (10)
+//   -seed N              seed of the random DAG (0)
+//   -colors N            colors, or 0 for -colors_per_core per core (0)
+//   -colors_per_core N   overdecomposition (1)
+//
+// ---------------------------------------------------------------------------------
+
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+#include "legion.h"
+#include "state.hh"
+#include "evaluators.hh"
+#include "task_managers.hh"
+#include "mapper.hh"
+#include "input_args.hh"
+#include "synthetic.hh"
+#include "UniqueHelpers.hh"
+
+using namespace Legion;
+using namespace Arcos;
+
+enum TaskIDList {
+  TOP_LEVEL_TASK_ID,
+};
+
+
+void top_level_task(const Task *task,
+                    const std::vector<PhysicalRegion> &regions,
+                    Context ctx, Runtime *runtime)
+{
+  std::string shape = InputArg("-dag", "layered");
+  int width = std::atoi(InputArg("-width", "8"));
+  int depth = std::atoi(InputArg("-depth", "8"));
+  int fan_in = std::atoi(InputArg("-fan_in", "2"));
+  int ncells = std::atoi(InputArg("-cells", "1000"));
+  int steps = std::atoi(InputArg("-steps", "10"));
+  unsigned seed = std::atoi(InputArg("-seed", "0"));
+  if (shape != "layered" && shape != "random") {
+    std::cout << "dag_benchmark: -dag must be layered or random" << std::endl;
+    throw("dag_benchmark: bad -dag");
+  }
+
+  auto dag = GenerateDag(shape == "layered" ? DagShape::LAYERED : DagShape::RANDOM,
+                         width, depth, fan_in, seed);
+
+  State s(ctx, runtime, ncells);
+  s.colors = std::atoi(InputArg("-colors", "0"));
+  s.colors_per_core = std::atoi(InputArg("-colors_per_core", "1"));
+
+  // every key is launched every step, so nothing may be folded away
+  s.uniform_primaries = false;
+  for (size_t i = 0; i != dag.keys.size(); ++i) {
+    if (dag.deps[i].empty()) {
+      s.RequireEvaluator(dag.keys[i],
+              std::make_unique<EvaluatorPrimary<TaskManagerPrimary<double> > >(dag.keys[i], 1.0));
+    } else {
+      s.RequireEvaluator(dag.keys[i],
+              std::make_unique<EvaluatorSecondary<TaskManagerSynthetic,FSynthetic> >(dag.keys[i], dag.deps[i], s));
+    }
+  }
+  s.Setup();
+
+  int ncores = runtime->select_tunable_value(ctx,
+          Mapping::DefaultMapper::DEFAULT_TUNABLE_GLOBAL_CPUS, 0).get_result<size_t>();
+  auto color_domain = runtime->get_index_space_domain(ctx, s.partition);
+  int nlaunches = s.plan_keys.size();
+
+  double host_total = 0., step_total = 0., busy_total = 0.;
+  for (int step = 0; step <= steps; ++step) {
+    runtime->issue_execution_fence(ctx).get_void_result();
+    auto start = std::chrono::steady_clock::now();
+    for (const auto& key : s.plan_keys) s.evaluators.at(key)->Launch(s);
+    double host = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    for (const auto& key : s.plan_keys) s.futures.at(key).wait_all_results();
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double busy = 0.;
+    for (const auto& key : s.plan_keys)
+      for (Domain::DomainPointIterator c(color_domain); c; c++)
+        busy += s.futures.at(key).get_result<TaskStats>(*c).time;
+    s.EndStep();
+
+    // the first step includes mapping and instance creation
+    if (step == 0) continue;
+    host_total += host;
+    step_total += wall;
+    busy_total += busy;
+  }
+
+  printf("\nDAG benchmark: %s, width %d, depth %d, fan-in %d, %d cells, %d work\n",
+         shape.c_str(), width, depth, fan_in, ncells, FSynthetic::Work());
+  printf("  %d launches of %lu colors on %d cores, %d steps\n",
+         nlaunches, color_domain.get_volume(), ncores, steps);
+  printf("  %-28s %12.3e\n", "host time per launch [s]", host_total / (steps * nlaunches));
+  printf("  %-28s %12.3e\n", "step time [s]", step_total / steps);
+  printf("  %-28s %12.3e\n", "busy time per step [s]", busy_total / steps);
+  printf("  %-28s %12.3f\n", "parallelism [cores]", busy_total / step_total);
+  printf("  %-28s %12.3f\n", "efficiency", busy_total / step_total / ncores);
+  printf("  %-28s %12.3e\n", "overhead per launch [s]",
+         (step_total - busy_total / ncores) / (steps * nlaunches));
+}
+
+
+int main(int argc, char **argv) {
+  {
+    TaskVariantRegistrar tvr(TOP_LEVEL_TASK_ID, "top_level_task");
+    tvr.add_constraint(ProcessorConstraint(Processor::LOC_PROC));
+    Runtime::preregister_task_variant<top_level_task>(tvr, "top_level_task");
+    Runtime::set_top_level_task_id(TOP_LEVEL_TASK_ID);
+  }
+
+  TaskManagerPrimary<double>::preregister_task();
+  TaskManagerSynthetic::preregister_task();
+  TaskManagerInner::preregister_task();
+
+  ArcosMapper::Register();
+
+  return Runtime::start(argc,argv);
+}
@@ -0,0 +1,136 @@
+//! --------------------------------------------------------------------------------
+//
+// Arcos -- Legion
+//
+// Author: Ethan Coon (coonet@ornl.gov)
+// License: BSD
+//
+// Synthetic evaluator DAGs for benchmarking State.
+//
+// ---------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include "synthetic.hh"
+#include "input_args.hh"
+
+namespace Arcos {
+
+SyntheticDag
+GenerateDag(DagShape shape, int width, int depth, int fan_in, unsigned seed)
+{
+  assert(width > 0 && depth > 0);
+  if (fan_in < 1 || fan_in > ARCOS_MAX_ARGS) {
+    std::cout << "GenerateDag: fan_in must be in [1, " << ARCOS_MAX_ARGS << "]" << std::endl;
+    throw("GenerateDag: bad fan_in");
+  }
+
+  std::mt19937 gen(seed);
+  SyntheticDag dag;
+  for (int l = 0; l != depth; ++l) {
+    for (int i = 0; i != width; ++i) {
+      dag.keys.push_back("L" + std::to_string(l) + "_" + std::to_string(i));
+      dag.deps.push_back(std::vector<std::string>());
+      if (l == 0) continue;
+
+      // the candidates: the layer before, or everything before
+      int lo = shape == DagShape::LAYERED ? (l-1) * width : 0;
+      int hi = l * width;
+      int n = std::min(fan_in, hi - lo);
+      std::vector<int> candidates(hi - lo);
+      for (int c = 0; c != (int) candidates.size(); ++c) candidates[c] = lo + c;
+      for (int a = 0; a != n; ++a) {
+        // a partial Fisher-Yates shuffle, for distinct arguments
+        std::uniform_int_distribution<int> pick(a, candidates.size()-1);
+        std::swap(candidates[a], candidates[pick(gen)]);
+        dag.deps.back().push_back(dag.keys[candidates[a]]);
+      }
+    }
+  }
+  return dag;
+}
+
+
+double
+FSynthetic::Apply(const double* args, int nargs)
+{
+  double v = 0.;
+  for (int i = 0; i != nargs; ++i) v += args[i];
+  v /= nargs;
+  for (int w = Work(); w > 0; --w) v = 0.5 * v + 1.;
+  return v;
+}
+
+
+int
+FSynthetic::Work()
+{
+  // read once, by whichever task first gets here
+  static const int work = std::atoi(InputArg("-work", "0"));
+  return work;
+}
+
+const char* FSynthetic::name = "fsynthetic";
+
+
+Legion::TaskID TaskManagerSynthetic::taskid = 0;
+
+void
+TaskManagerSynthetic::preregister_task(Legion::TaskID new_taskid)
+{
+  taskid = ((new_taskid == AUTO_GENERATE_ID) ?
+            Legion::Runtime::generate_static_task_id() :
+            new_taskid);
+  std::cout << "Registering task: " << FSynthetic::name << std::endl;
+  Legion::TaskVariantRegistrar tvr(taskid, FSynthetic::name);
+  tvr.add_constraint(Legion::ProcessorConstraint(Legion::Processor::LOC_PROC));
+  tvr.set_leaf(true);
+  Legion::Runtime::preregister_task_variant<TaskStats, &TaskManagerSynthetic::cpu_task>(tvr, FSynthetic::name);
+}
+
+
+double
+TaskManagerSynthetic::evaluate(const std::vector<double>& values)
+{
+  return FSynthetic::Apply(values.data(), values.size());
+}
+
+
+TaskStats
+TaskManagerSynthetic::cpu_task(const Legion::Task *task,
+                               const std::vector<Legion::PhysicalRegion> &regions,
+                               Legion::Context ctx, Legion::Runtime *runtime)
+{
+  auto start = std::chrono::steady_clock::now();
+  bool counting = PerfCounters::Enabled();
+  if (counting) PerfCounters::Thread().Start();
+  assert(task->arglen == sizeof(PlanEntry));
+  const PlanEntry& entry = *(const PlanEntry*) task->args;
+
+  // synthetic DAGs are on 1D domains
+  auto domain = runtime->get_index_space_domain(ctx, task->regions[0].region.get_index_space());
+  assert(domain.get_dim() == 1);
+  std::vector<Legion::FieldAccessor<READ_ONLY,double,1> > accessors;
+  auto args = argReaders<1>(entry, task, regions, 1, accessors);
+  const Legion::FieldAccessor<WRITE_DISCARD,double,1> out(regions[0], entry.out_fid);
+
+  double v[ARCOS_MAX_ARGS];
+  for (Legion::PointInRectIterator<1> p(domain); p(); ++p) {
+    for (int i = 0; i != entry.nargs; ++i) v[i] = args[i][*p];
+    out[*p] = FSynthetic::Apply(v, entry.nargs);
+  }
+
+  int nfields = 0;
+  for (int i = 0; i != entry.nargs; ++i)
+    if (!entry.arg_uniform[i] && !entry.arg_scalar[i]) nfields++;
+  TaskStats stats{};
+  stats.counters = counting ? PerfCounters::Thread().Stop() : PerfSample{-1., -1., -1., -1.};
+  stats.time = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  stats.bytes_read = nfields * domain.get_volume() * sizeof(double);
+  stats.bytes_written = domain.get_volume() * sizeof(double);
+  return stats;
+}
+
+} // namespace Arcos
@@ -0,0 +1,77 @@
+//! --------------------------------------------------------------------------------
+//
+// Arcos -- Legion
+//
+// Author: Ethan Coon (coonet@ornl.gov)
+// License: BSD
+//
+// Synthetic evaluator DAGs for benchmarking State.
+//
+// A synthetic DAG has width primaries, and depth-1 further layers of
+// width secondaries, each reading fan_in keys:
+//
+//   * LAYERED: each secondary reads keys of the layer just before it
+//   * RANDOM: each secondary reads any keys before it, so paths skip
+//     layers and the DAG's depth and width vary
+//
+// Every secondary evaluates the same function, the mean of its
+// arguments followed by a chain of work floating point operations per
+// cell, so that the cost of a launch is set by the number of cells and
+// work.  A single task manager serves any fan-in, reading the number of
+// arguments from the plan entry instead of from its template arguments.
+//
+// ---------------------------------------------------------------------------------
+
+#ifndef ARCOS_SYNTHETIC_HH_
+#define ARCOS_SYNTHETIC_HH_
+
+#include <string>
+#include <vector>
+#include "legion.h"
+#include "task_managers.hh"
+
+namespace Arcos {
+
+enum class DagShape { LAYERED, RANDOM };
+
+//
+// A generated DAG: each key, and the keys it reads (none for primaries),
+// in dependency order.
+// =============================================================================
+struct SyntheticDag {
+  std::vector<std::string> keys;
+  std::vector<std::vector<std::string> > deps;
+};
+
+SyntheticDag
+GenerateDag(DagShape shape, int width, int depth, int fan_in, unsigned seed);
+
+
+//
+// The function of every synthetic secondary.
+// =============================================================================
+struct FSynthetic {
+  static double Apply(const double* args, int nargs);
+
+  // floating point operations per cell, from -work (default 0)
+  static int Work();
+  static const char* name;
+};
+
+
+//
+// A task manager for synthetic secondaries, of any fan-in up to
+// ARCOS_MAX_ARGS.
+// =============================================================================
+struct TaskManagerSynthetic {
+  static Legion::TaskID taskid;
+  static void preregister_task(Legion::TaskID new_taskid = AUTO_GENERATE_ID);
+  static double evaluate(const std::vector<double>& values);
+  static TaskStats cpu_task(const Legion::Task *task,
+                            const std::vector<Legion::PhysicalRegion> &regions,
+                            Legion::Context ctx, Legion::Runtime *runtime);
+};
+
+} // namespace Arcos
+
+#endif
@@ -0,0 +1,187 @@
+#!/usr/bin/env python3
+"""Compares the execution strategies of 00_tasks .. 06_state_regions_indexed.
+
+Every variant evaluates the same A-H DAG, and prints one line
+
+    Timing: <cells> cells, <colors> colors, <steps> steps, <seconds> s
+
+for the problem it actually ran.  This builds each variant against
+Legion ($LG_RT_DIR), runs it for each cell count and core count with the
+common options
+
+    -ll:cpu <cores> -cells <cells> -colors <cores> -steps <steps>
+
+(and -uniform 0 for the State drivers, so 06 launches every key rather
+than folding the uniform ones on the host), and tabulates the time per
+step.  Variants on doubles (00-02) have no cells, and a variant that
+does not honor -cells is reported at the size it ran, once.  Output is
+read line by line and only the Timing line is kept, so chatty variants
+cost no memory here.
+
+With --save-baseline the results are written as JSON; with --baseline
+they are compared against such a file, and the script exits nonzero if
+any case is slower than the baseline by more than --tolerance.
+
+Author: Ethan Coon (coonet@ornl.gov)
+License: BSD
+"""
+
+import argparse
+import json
+import os
+import re
+import subprocess
+import sys
+import threading
+
+VARIANTS = [
+    ("00_tasks", "tasks"),
+    ("01_futures", "futures"),
+    ("02_state_doubles", "a.out"),
+    ("03_regions", "regions"),
+    ("04_state_regions", "a.out"),
+    ("05_regions_indexed", "regions"),
+    ("06_state_regions_indexed", "a.out"),
+]
+
+# options for the State drivers (a.out), which otherwise fold uniform keys
+STATE_ARGS = ["-uniform", "0"]
+
+TIMING = re.compile(r"^Timing: (\d+) cells, (\d+) colors, (\d+) steps, (\S+) s$")
+
+ROOT = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+
+
+def build(variant, make_args):
+    print("Building %s" % variant, file=sys.stderr)
+    subprocess.check_call(["make", "-C", os.path.join(ROOT, variant)] + make_args,
+                          stdout=subprocess.DEVNULL)
+
+
+def run(variant, exe, cells, cores, steps, timeout):
+    """Runs a variant, returning (cells, colors, seconds per step) or None."""
+    cmd = [os.path.join(ROOT, variant, exe), "-ll:cpu", str(cores),
+           "-cells", str(cells), "-colors", str(cores), "-steps", str(steps)]
+    if exe == "a.out":
+        cmd += STATE_ARGS
+    proc = subprocess.Popen(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                            universal_newlines=True)
+    timed_out = threading.Event()
+
+    def kill():
+        timed_out.set()
+        proc.kill()
+
+    timer = threading.Timer(timeout, kill)
+    timer.start()
+    m = None
+    try:
+        for line in proc.stdout:
+            m = TIMING.match(line.rstrip("\n")) or m
+        returncode = proc.wait()
+    finally:
+        timer.cancel()
+        proc.stdout.close()
+    if timed_out.is_set():
+        print("  %s timed out: %s" % (variant, " ".join(cmd)), file=sys.stderr)
+        return None
+    if returncode != 0 or m is None:
+        print("  %s failed (%d): %s" % (variant, returncode, " ".join(cmd)), file=sys.stderr)
+        return None
+    ran_cells, colors, ran_steps, seconds = m.groups()
+    return int(ran_cells), int(colors), float(seconds) / int(ran_steps)
+
+
+def case_key(variant, cells, cores):
+    return "%s/%d/%d" % (variant, cells, cores)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("--cells", type=int, nargs="+",
+                        default=[10**e for e in range(2, 9)], help="cell counts")
+    parser.add_argument("--cores", type=int, nargs="+", default=[1, 2, 4],
+                        help="core counts (-ll:cpu)")
+    parser.add_argument("--steps", type=int, default=1, help="steps per run")
+    parser.add_argument("--repeat", type=int, default=3,
+                        help="runs of each case, of which the fastest is kept")
+    parser.add_argument("--variants", nargs="+", default=[v for v, _ in VARIANTS],
+                        help="variant directories")
+    parser.add_argument("--no-build", action="store_true", help="use existing binaries")
+    parser.add_argument("--make-args", nargs="*", default=["DEBUG=0", "OUTPUT_LEVEL=LEVEL_WARNING"],
+                        help="overrides passed to make")
+    parser.add_argument("--timeout", type=float, default=600., help="seconds per run")
+    parser.add_argument("--save-baseline", metavar="FILE", help="write results as a baseline")
+    parser.add_argument("--baseline", metavar="FILE", help="compare against a baseline")
+    parser.add_argument("--tolerance", type=float, default=0.1,
+                        help="allowed slowdown against the baseline, as a fraction")
+    parser.add_argument("--noise", type=float, default=1.e-3,
+                        help="slowdowns under this many seconds are not regressions")
+    args = parser.parse_args()
+
+    exes = dict(VARIANTS)
+    for v in args.variants:
+        if v not in exes:
+            parser.error("unknown variant %s" % v)
+    if not args.no_build:
+        if "LG_RT_DIR" not in os.environ:
+            parser.error("LG_RT_DIR must point to Legion's runtime directory")
+        for v in args.variants:
+            build(v, args.make_args)
+
+    # results[(variant, cells, cores)] = (colors, seconds per step)
+    results = {}
+    for v in args.variants:
+        for cores in args.cores:
+            for cells in args.cells:
+                best = None
+                for _ in range(args.repeat):
+                    r = run(v, exes[v], cells, cores, args.steps, args.timeout)
+                    if r is not None and (best is None or r[2] < best[2]):
+                        best = r
+                if best is None:
+                    continue
+                ran_cells, colors, seconds = best
+                results[(v, ran_cells, cores)] = (colors, seconds)
+                # a variant of fixed size gives the same answer for every size
+                if ran_cells != cells:
+                    break
+
+    # the comparison: one row per problem, one column per variant
+    rows = sorted(set((cells, cores) for _, cells, cores in results))
+    print("%10s %6s" % ("cells", "cores") + "".join(" %*s" % (len(v), v) for v in args.variants))
+    for cells, cores in rows:
+        line = "%10d %6d" % (cells, cores)
+        for v in args.variants:
+            r = results.get((v, cells, cores))
+            line += " %*s" % (len(v), "%.4e" % r[1] if r else "-")
+        print(line)
+
+    flat = {case_key(v, cells, cores): r[1] for (v, cells, cores), r in results.items()}
+    if args.save_baseline:
+        with open(args.save_baseline, "w") as f:
+            json.dump(flat, f, indent=2, sort_keys=True)
+        print("Saved baseline to %s" % args.save_baseline)
+
+    if args.baseline:
+        with open(args.baseline) as f:
+            baseline = json.load(f)
+        regressions = []
+        for key, seconds in sorted(flat.items()):
+            if key not in baseline:
+                continue
+            base = baseline[key]
+            if seconds > base * (1. + args.tolerance) and seconds - base > args.noise:
+                regressions.append((key, base, seconds))
+        if regressions:
+            print("\nRegressions against %s:" % args.baseline)
+            for key, base, seconds in regressions:
+                print("  %-40s %.4e -> %.4e s (%+.1f%%)" % (key, base, seconds,
+                                                           100. * (seconds / base - 1.)))
+            return 1
+        print("\nNo regressions against %s" % args.baseline)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,148 @@
+#!/usr/bin/env python3
+"""Strong and weak scaling of the State DAG (06_state_regions_indexed).
+
+Strong scaling runs a fixed total number of cells on each core count;
+weak scaling a fixed number of cells per core.  Each run is
+
+    <exe> -ll:cpu <cores> -cells <cells> -steps <steps> [extra options] -uniform 0
+
+so that every key is launched rather than folded on the host, and its
+Timing line, the only line of output kept, gives the time per step.  Parallel efficiency is
+T(p0) p0 / (T(p) p) for strong scaling and T(p0) / T(p) for weak
+scaling, against the smallest core count p0.  The memory high-water mark
+is the peak resident set size of the run; the driver holds only two
+steps of launch futures, so it does not grow with --steps.  One CSV row is written per
+run, e.g.
+
+    benchmarks/scaling.py --cores 1 2 4 8 --strong-cells 10000000 \\
+        --weak-cells 1000000 --csv scaling.csv -- -colors_per_core 2
+
+Author: Ethan Coon (coonet@ornl.gov)
+License: BSD
+"""
+
+import argparse
+import csv
+import os
+import subprocess
+import sys
+import threading
+
+from compare_variants import ROOT, STATE_ARGS, TIMING, build
+
+FIELDS = ["mode", "cores", "cells", "colors", "steps", "step_time",
+          "speedup", "efficiency", "max_rss_kb"]
+
+
+def run(exe, cores, cells, steps, extra, timeout):
+    """Runs once, returning (colors, seconds per step, peak RSS in kB) or None."""
+    # the first of repeated options wins, so extra may override STATE_ARGS
+    cmd = [exe, "-ll:cpu", str(cores), "-cells", str(cells), "-steps", str(steps)] \
+        + extra + STATE_ARGS
+    proc = subprocess.Popen(cmd, stdout=subprocess.PIPE, stderr=subprocess.STDOUT,
+                            universal_newlines=True)
+    timed_out = threading.Event()
+
+    def kill():
+        timed_out.set()
+        proc.kill()
+
+    timer = threading.Timer(timeout, kill)
+    timer.start()
+    m = None
+    try:
+        with proc.stdout:
+            for line in proc.stdout:
+                m = TIMING.match(line.rstrip("\n")) or m
+        # wait4 gives the resource usage of this run alone
+        _, status, rusage = os.wait4(proc.pid, 0)
+    finally:
+        timer.cancel()
+    proc.returncode = returncode = os.waitstatus_to_exitcode(status)
+    if timed_out.is_set():
+        print("  timed out: %s" % " ".join(cmd), file=sys.stderr)
+        return None
+    if returncode != 0 or m is None:
+        print("  failed (%d): %s" % (returncode, " ".join(cmd)), file=sys.stderr)
+        return None
+    _, colors, ran_steps, seconds = m.groups()
+    # ru_maxrss is in kB on Linux, bytes on macOS
+    rss = rusage.ru_maxrss // 1024 if sys.platform == "darwin" else rusage.ru_maxrss
+    return int(colors), float(seconds) / int(ran_steps), rss
+
+
+def study(mode, exe, cores_list, cells_of, steps, repeat, extra, timeout, writer):
+    base = None
+    for cores in cores_list:
+        cells = cells_of(cores)
+        best = None
+        for _ in range(repeat):
+            r = run(exe, cores, cells, steps, extra, timeout)
+            if r is not None and (best is None or r[1] < best[1]):
+                best = r
+        if best is None:
+            continue
+        colors, step_time, rss = best
+        if base is None:
+            base = (cores, step_time)
+        if mode == "strong":
+            speedup = base[1] / step_time
+            efficiency = speedup * base[0] / cores
+        else:
+            speedup = base[1] / step_time * cores / base[0]
+            efficiency = base[1] / step_time
+        row = dict(mode=mode, cores=cores, cells=cells, colors=colors, steps=steps,
+                   step_time="%.6e" % step_time, speedup="%.3f" % speedup,
+                   efficiency="%.3f" % efficiency, max_rss_kb=rss)
+        writer.writerow(row)
+        print("%-6s %5d cores %12d cells: %.4e s/step, efficiency %.3f, %d kB"
+              % (mode, cores, cells, step_time, efficiency, rss), file=sys.stderr)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.split("\n")[0])
+    parser.add_argument("--variant", default="06_state_regions_indexed",
+                        help="directory of the driver to run")
+    parser.add_argument("--exe", default="a.out", help="its executable")
+    parser.add_argument("--cores", type=int, nargs="+", default=[1, 2, 4, 8],
+                        help="core counts (-ll:cpu)")
+    parser.add_argument("--strong-cells", type=int, default=0,
+                        help="total cells for strong scaling (0 to skip)")
+    parser.add_argument("--weak-cells", type=int, default=0,
+                        help="cells per core for weak scaling (0 to skip)")
+    parser.add_argument("--steps", type=int, default=10, help="steps per run")
+    parser.add_argument("--repeat", type=int, default=3,
+                        help="runs of each case, of which the fastest is kept")
+    parser.add_argument("--timeout", type=float, default=600., help="seconds per run")
+    parser.add_argument("--csv", metavar="FILE", help="output (default stdout)")
+    parser.add_argument("--no-build", action="store_true", help="use the existing binary")
+    parser.add_argument("--make-args", nargs="*", default=["DEBUG=0", "OUTPUT_LEVEL=LEVEL_WARNING"],
+                        help="overrides passed to make")
+    parser.add_argument("extra", nargs="*", help="options passed through to the driver, after --")
+    args = parser.parse_args()
+
+    if not args.strong_cells and not args.weak_cells:
+        parser.error("give --strong-cells, --weak-cells, or both")
+    if not args.no_build:
+        if "LG_RT_DIR" not in os.environ:
+            parser.error("LG_RT_DIR must point to Legion's runtime directory")
+        build(args.variant, args.make_args)
+    exe = os.path.join(ROOT, args.variant, args.exe)
+    cores = sorted(args.cores)
+
+    out = open(args.csv, "w", newline="") if args.csv else sys.stdout
+    writer = csv.DictWriter(out, fieldnames=FIELDS)
+    writer.writeheader()
+    if args.strong_cells:
+        study("strong", exe, cores, lambda p: args.strong_cells,
+              args.steps, args.repeat, args.extra, args.timeout, writer)
+    if args.weak_cells:
+        study("weak", exe, cores, lambda p: args.weak_cells * p,
+              args.steps, args.repeat, args.extra, args.timeout, writer)
+    if args.csv:
+        out.close()
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())